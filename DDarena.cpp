@@ -0,0 +1,144 @@
+#include "DDarena.h"
+
+// 测试：arena 的基本行为，以及线程池里临时分配很多的任务用 malloc 和用 arena 的对比
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "DDthreadpool.h"
+#include "DDvector.h"
+using namespace DD;
+
+using steady = std::chrono::steady_clock;
+
+template<class T>
+using scratch_vector = DD::vector<T, arena_allocator<T>>;
+
+using scratch_string = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+
+void basics() {
+    arena a(1024);
+    void *p = a.allocate(10);
+    void *q = a.allocate(64, 64);
+    assert(reinterpret_cast<uintptr_t>(q) % 64 == 0);
+    a.deallocate(q, 64);    // 最近一次分配可以退回
+    assert(a.allocate(64, 64) == q);
+    (void) p;
+
+    // 超出第一块以后再申请更大的块，reset 后合成一块
+    for (int i = 0; i < 100; ++i) a.allocate(100);
+    std::cout << "before reset: used " << a.used() << ", capacity " << a.capacity() << ", blocks "
+              << a.blocks_allocated() << "\n";
+    a.reset();
+    for (int i = 0; i < 100; ++i) a.allocate(100);
+    std::cout << "after reset:  used " << a.used() << ", capacity " << a.capacity() << ", blocks "
+              << a.blocks_allocated() << ", high water " << a.high_water() << "\n";
+
+    // 容器通过 arena_allocator 使用当前线程的 arena
+    {
+        scratch_vector<int> v;
+        for (int i = 0; i < 1000; ++i) v.push_back(i);
+        scratch_string s("a string that is too long for the small string buffer");
+        std::vector<scratch_string, arena_allocator<scratch_string>> words;
+        for (int i = 0; i < 10; ++i) words.emplace_back(s);
+        assert(v[999] == 999 && words.back() == s);
+        std::cout << "this thread's arena: used " << this_worker::arena().used() << "\n";
+    }
+    this_worker::arena().reset();
+
+    // 赋值不会把 allocator 换成另一个 arena 的：元素拷贝/移动到自己的 arena 上
+    {
+        arena mine, other;
+        scratch_vector<int> v{arena_allocator<int>(mine)};
+        scratch_vector<int> w(3, 7, arena_allocator<int>(other));
+        v = w;
+        assert(v.get_allocator() == arena_allocator<int>(mine) && v.size() == 3 && v[2] == 7);
+        v = std::move(w);
+        assert(v.get_allocator() == arena_allocator<int>(mine) && v.size() == 3);
+        std::cout << "after assignment: mine used " << mine.used() << ", other used " << other.used() << "\n";
+    }
+
+    // 任务里用完就析构的大 vector：释放时退回了指针，高水位仍然要算上它
+    {
+        thread_pool pool(1);
+        pool.start(1);
+        std::atomic<bool> done{false};
+        pool.submit([&done] {
+            { scratch_vector<char> big(1 << 20); }
+            done = true;
+        });
+        while (!done) std::this_thread::yield();
+        pool.stop();    // stop() 会 join 工作线程，之后 reset() 已经做完
+        std::cout << "1 MiB vector in a task: high water " << pool.arena_high_water()[0] << "\n";
+        assert(pool.arena_high_water()[0] >= (1 << 20));
+    }
+}
+
+/**
+ * 一个临时分配很多的任务：拼字符串、往 vector 里放元素、把字符串收集起来，最后只返回一个数。
+ * Vector / String / List 决定内存从哪里来
+ */
+template<class Vector, class String, class List>
+uint64_t work(int seed) {
+    Vector numbers;
+    List words;
+    uint64_t h = 0;
+    for (int i = 0; i < 64; ++i) {
+        String s("request-");
+        s += std::to_string(seed + i).c_str();
+        s += "-with-a-payload-longer-than-sso";
+        words.push_back(s);
+        for (int k = 0; k < 16; ++k) numbers.push_back(seed * k + i);
+    }
+    for (auto &w : words) h += w.size();
+    for (auto &x : numbers) h += uint64_t(x);
+    return h;
+}
+
+const int tasks = 20000;
+
+template<bool UseArena>
+void bench(int threads, uint64_t expected) {
+    std::atomic<uint64_t> sink{0};
+    DD::latch finished(tasks);
+    thread_pool pool(1024);
+    pool.start(threads);
+    auto begin = steady::now();
+    for (int i = 0; i < tasks; ++i) {
+        pool.submit([i, &sink, &finished] {
+            uint64_t h;
+            if constexpr (UseArena) {
+                h = work<scratch_vector<int>, scratch_string, std::vector<scratch_string, arena_allocator<scratch_string>>>(i);
+            } else {
+                h = work<DD::vector<int>, std::string, std::vector<std::string>>(i);
+            }
+            sink.fetch_add(h, std::memory_order_relaxed);
+            finished.count_down();
+        });
+    }
+    finished.wait();    // stop() 不会执行队列里剩下的任务，先等所有任务做完
+    pool.stop();
+    std::chrono::duration<double, std::milli> d = steady::now() - begin;
+    std::cout << (UseArena ? "arena " : "malloc") << " threads " << threads << ": " << d.count() << " ms, "
+              << d.count() * 1e6 / tasks << " ns/task";
+    if (UseArena) {
+        std::cout << ", high water";
+        for (size_t hw : pool.arena_high_water()) std::cout << " " << hw;
+    }
+    std::cout << "\n";
+    assert(sink == expected);
+}
+
+int main() {
+    basics();
+
+    // 两种方式做的是同样的工作：结果和串行计算的一致
+    uint64_t expected = 0;
+    for (int i = 0; i < tasks; ++i) expected += work<DD::vector<int>, std::string, std::vector<std::string>>(i);
+    for (int threads : {1, 2, 4, 8}) {
+        bench<false>(threads, expected);
+        bench<true>(threads, expected);
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+// 线程私有的临时内存区：分配就是移动指针，任务结束后整体回收
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace DD {
+/**
+ * 从一串内存块里按顺序切出内存，单次分配只是对齐加一次比较，不加锁、不碰全局的 malloc。
+ * 1. deallocate() 只在释放的是最近一次分配时把指针退回去，其余情况什么都不做，内存等 reset() 统一回收。
+ * 2. 块用完了就向 operator new 要一块更大的(至少翻倍)；reset() 时如果用了不止一块，
+ *    就换成一整块和这次总量一样大的(不超过 max_retained)，之后同样大小的工作只用一块，不再调用 malloc。
+ * 3. 只有所属线程可以分配和 reset；used() 以外的统计是原子的，其他线程可以随时读。
+ * 第一次分配时才申请内存，从不使用的 arena 不占内存。
+ */
+class arena {
+public:
+    explicit arena(size_t block_size = 64 * 1024, size_t max_retained = 16 * 1024 * 1024)
+        : block_size_(block_size), max_retained_(std::max(block_size, max_retained)) {}
+
+    arena(const arena &) = delete;
+
+    arena &operator=(const arena &) = delete;
+
+    ~arena() { release(); }
+
+    void *allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        uintptr_t p = (cur_ + align - 1) & ~uintptr_t(align - 1);
+        if (p < cur_ || p > end_ || bytes > end_ - p) return allocate_slow(bytes, align);
+        cur_ = p + bytes;
+        return reinterpret_cast<void *>(p);
+    }
+
+    // 最近一次分配可以退回去(临时字符串、先分配后释放的场景常见)，其他的等 reset()
+    void deallocate(void *p, size_t bytes) noexcept {
+        if (reinterpret_cast<uintptr_t>(p) + bytes == cur_) {
+            peak_ = std::max(peak_, used());    // 退回之前先记下用量，否则 reset() 时看到的是退回后的
+            cur_ = reinterpret_cast<uintptr_t>(p);
+        }
+    }
+
+    // 回收所有分配；之前分配出去的内存都不能再用
+    void reset() noexcept {
+        if (blocks_.empty()) return;
+        note_high_water();
+        if (blocks_.size() > 1) {
+            size_t total = std::min(capacity(), max_retained_);
+            release();
+            try {
+                add_block(total);
+            } catch (const std::bad_alloc &) {
+                return;     // 保持为空，下次分配时再申请
+            }
+        }
+        used_before_ = 0;
+        cur_ = blocks_.empty() ? 0 : blocks_.back().begin;
+        end_ = blocks_.empty() ? 0 : blocks_.back().end;
+    }
+
+    // 当前已经分配出去的字节数(含对齐填充)，只能在所属线程调用
+    size_t used() const noexcept {
+        return blocks_.empty() ? 0 : used_before_ + (cur_ - blocks_.back().begin);
+    }
+
+    // 历次 reset() 之前用量的最大值(包括中途已经退回的部分)
+    size_t high_water() const noexcept { return high_water_.load(std::memory_order_relaxed); }
+
+    // 当前持有的内存
+    size_t capacity() const noexcept { return capacity_.load(std::memory_order_relaxed); }
+
+    // 向 operator new 申请内存块的次数
+    uint64_t blocks_allocated() const noexcept { return blocks_allocated_.load(std::memory_order_relaxed); }
+
+private:
+    struct block {
+        uintptr_t begin;
+        uintptr_t end;
+    };
+
+    void *allocate_slow(size_t bytes, size_t align) {
+        size_t used_here = blocks_.empty() ? 0 : cur_ - blocks_.back().begin;
+        size_t last = blocks_.empty() ? 0 : blocks_.back().end - blocks_.back().begin;
+        add_block(std::max({block_size_, last * 2, bytes + align}));
+        used_before_ += used_here;
+        uintptr_t p = (cur_ + align - 1) & ~uintptr_t(align - 1);
+        cur_ = p + bytes;
+        return reinterpret_cast<void *>(p);
+    }
+
+    void add_block(size_t size) {
+        blocks_.reserve(blocks_.size() + 1);
+        auto p = reinterpret_cast<uintptr_t>(::operator new(size));
+        blocks_.push_back(block{p, p + size});
+        cur_ = p;
+        end_ = p + size;
+        capacity_.store(capacity() + size, std::memory_order_relaxed);
+        blocks_allocated_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() noexcept {
+        for (auto &b : blocks_) ::operator delete(reinterpret_cast<void *>(b.begin));
+        blocks_.clear();
+        cur_ = end_ = 0;
+        used_before_ = 0;
+        capacity_.store(0, std::memory_order_relaxed);
+    }
+
+    void note_high_water() noexcept {
+        size_t u = std::max(peak_, used());
+        peak_ = 0;
+        if (u > high_water_.load(std::memory_order_relaxed)) high_water_.store(u, std::memory_order_relaxed);
+    }
+
+    uintptr_t cur_ = 0;     // 当前块里下一个空闲字节
+    uintptr_t end_ = 0;     // 当前块的末尾
+    size_t used_before_ = 0;    // 之前几个块里用掉的字节
+    size_t peak_ = 0;           // 上次 reset() 以来 deallocate() 退回之前的最大用量
+    std::vector<block> blocks_;     // 最后一个是当前块
+    size_t block_size_;
+    size_t max_retained_;
+    std::atomic<size_t> high_water_{0};
+    std::atomic<size_t> capacity_{0};
+    std::atomic<uint64_t> blocks_allocated_{0};
+};
+
+namespace this_worker {
+namespace detail {
+inline DD::arena *&current() {
+    static thread_local DD::arena *a = nullptr;
+    return a;
+}
+}; // namespace detail
+
+// 线程池在工作线程开始时绑定它的 arena；传 nullptr 解除绑定
+inline void bind_arena(DD::arena *a) noexcept { detail::current() = a; }
+
+/**
+ * 当前线程的临时内存区。在 DD::thread_pool 的任务里它是工作线程的 arena，每个任务结束后自动 reset()，
+ * 所以从这里分配的内存不能留到任务结束以后；不在线程池里的线程得到一个线程私有的 arena，需要自己 reset()
+ */
+inline DD::arena &arena() noexcept {
+    if (DD::arena *a = detail::current()) return *a;
+    static thread_local DD::arena own;
+    return own;
+}
+}; // namespace this_worker
+
+/**
+ * 把容器的内存放到 arena 上的 allocator，需要时显式使用：
+ *     DD::vector<int, DD::arena_allocator<int>> v;        // 用当前工作线程的 arena
+ *     std::basic_string<char, std::char_traits<char>, DD::arena_allocator<char>> s;
+ * 容器必须在任务结束前析构(析构时的 deallocate 会碰 arena)，只能在所属线程使用。
+ */
+template<class T>
+class arena_allocator {
+public:
+    using value_type = T;
+
+    arena_allocator() noexcept : arena_(&this_worker::arena()) {}
+
+    explicit arena_allocator(DD::arena &a) noexcept : arena_(&a) {}
+
+    template<class U>
+    arena_allocator(const arena_allocator<U> &rhs) noexcept : arena_(rhs.arena_) {}
+
+    T *allocate(size_t n) {
+        if (n > size_t(-1) / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, size_t n) noexcept { arena_->deallocate(p, n * sizeof(T)); }
+
+    template<class U>
+    bool operator==(const arena_allocator<U> &rhs) const noexcept { return arena_ == rhs.arena_; }
+
+    template<class U>
+    bool operator!=(const arena_allocator<U> &rhs) const noexcept { return arena_ != rhs.arena_; }
+
+private:
+    template<class U>
+    friend class arena_allocator;
+
+    DD::arena *arena_;
+};
+}; // namespace DD
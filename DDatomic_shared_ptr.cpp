@@ -0,0 +1,97 @@
+#include "DDatomic_shared_ptr.h"
+
+// 测试
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace DD;
+
+// 路由表：读者每次请求都要查，写者偶尔整体替换
+using routing_table = std::map<int, std::string>;
+
+routing_table make_table(int version) {
+    routing_table t;
+    for (int i = 0; i < 16; ++i) {
+        t[i] = "backend-" + std::to_string(version) + "-" + std::to_string(i);
+    }
+    return t;
+}
+
+// 对照组：每次读都在互斥量里拷贝一次 shared_ptr
+struct locked_table {
+    shared_ptr<const routing_table> load() {
+        std::lock_guard<std::mutex> lk(m_);
+        return p_;
+    }
+
+    void store(shared_ptr<const routing_table> p) {
+        std::lock_guard<std::mutex> lk(m_);
+        p_ = std::move(p);
+    }
+
+    std::mutex m_;
+    shared_ptr<const routing_table> p_;
+};
+
+// nthreads 个读者读 ms 毫秒，同时一个写者每毫秒发布一个新版本，返回读者总吞吐(百万次/秒)
+template<class Read, class Write>
+double bench(int nthreads, int ms, Read read, Write write) {
+    std::atomic<bool> stop{false};
+    std::atomic<long> total{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < nthreads; ++t) {
+        readers.emplace_back([&] {
+            auto r = read();
+            long n = 0, sum = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                sum += r();
+                ++n;
+            }
+            total += n + (sum == -1);
+        });
+    }
+    std::thread writer([&] {
+        for (int v = 1; !stop.load(); ++v) {
+            write(v);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    stop = true;
+    for (auto &t : readers) t.join();
+    writer.join();
+    return total / (ms * 1000.0);
+}
+
+int main() {
+    // 1. 基本用法：旧快照在新版本发布之后仍然有效
+    atomic_shared_ptr<const routing_table> routes(DD::make_shared<const routing_table>(make_table(0)));
+    atomic_shared_ptr<const routing_table>::reader reader(routes);
+    auto old = routes.load();
+    routes.store(DD::make_shared<const routing_table>(make_table(1)));
+    std::cout << "old snapshot: " << old->at(0) << ", reader sees: " << reader->at(0)
+              << ", version " << routes.version() << "\n";
+
+    // 2. 读者吞吐：一个写者持续发布新版本
+    int hw = std::max(1u, std::thread::hardware_concurrency());
+    for (int n = 1; n <= hw * 2; n *= 2) {
+        locked_table locked;
+        locked.store(DD::make_shared<const routing_table>(make_table(0)));
+        double a = bench(n, 200,
+                         [&] { return [&] { return locked.load()->size(); }; },
+                         [&](int v) { locked.store(DD::make_shared<const routing_table>(make_table(v))); });
+
+        double b = bench(n, 200,
+                         [&] {
+                             return [r = atomic_shared_ptr<const routing_table>::reader(routes)]() mutable {
+                                 return r->size();
+                             };
+                         },
+                         [&](int v) { routes.store(DD::make_shared<const routing_table>(make_table(v))); });
+        std::cout << n << " readers: mutex+shared_ptr " << a << " M/s, atomic_shared_ptr::reader " << b << " M/s\n";
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+#include "DDshared_ptr.h"
+
+namespace DD {
+/**
+ * 读多写少的快照指针：写者偶尔发布新版本，读者无锁地拿到一个一致的快照。
+ *
+ * 1. 分离计数(split count)：当前版本的节点指针和一个"外部计数"打包在同一个 64 位原子变量里，
+ *    读者用一次 fetch_add 同时拿到指针并登记自己，不需要锁，拷贝完 shared_ptr 之后再把计数减回去。
+ *    写者替换节点时把外部计数转移到旧节点的内部计数上，最后一个离开的读者负责释放旧节点。
+ * 2. 延迟计数：reader 缓存上一次拿到的快照和版本号，版本没变时只读一次 version_，
+ *    不写任何共享的缓存行，所以读吞吐可以随核数线性增长。
+ *
+ * 旧版本的对象由 shared_ptr 管理，所有 reader 都换到新版本之后自动释放。
+ */
+template<class T, class Policy = thread_safe>
+class atomic_shared_ptr {
+    static_assert(sizeof(void *) == 8, "atomic_shared_ptr packs a 48-bit pointer with a 16-bit count");
+
+public:
+    using value_type = shared_ptr<T, Policy>;
+
+    explicit atomic_shared_ptr(value_type value = value_type())
+        : packed_(pack(new node(std::move(value), 0))) {}
+
+    atomic_shared_ptr(const atomic_shared_ptr &) = delete;
+
+    atomic_shared_ptr &operator=(const atomic_shared_ptr &) = delete;
+
+    ~atomic_shared_ptr() {
+        uint64_t old = packed_.load(std::memory_order_acquire);
+        release(unpack(old), count(old));
+    }
+
+    // 发布新版本：写者之间用互斥量串行化，读者不受影响
+    void store(value_type value) {
+        std::lock_guard<std::mutex> lk(write_m_);
+        uint64_t v = version_.load(std::memory_order_relaxed) + 1;
+        node *n = new node(std::move(value), v);
+        uint64_t old = packed_.exchange(pack(n), std::memory_order_acq_rel);
+        version_.store(v, std::memory_order_release);
+        release(unpack(old), count(old));
+    }
+
+    // 无锁地拿到当前版本
+    value_type load() const {
+        uint64_t version;
+        return acquire(version);
+    }
+
+    uint64_t version() const noexcept { return version_.load(std::memory_order_acquire); }
+
+    // 每个读线程持有一个 reader，版本不变时读取不产生任何共享写
+    class reader {
+    public:
+        explicit reader(const atomic_shared_ptr &src) : src_(&src) { refresh(); }
+
+        const value_type &get() {
+            if (src_->version_.load(std::memory_order_acquire) != version_) {
+                refresh();
+            }
+            return snapshot_;
+        }
+
+        const T &operator*() { return *get(); }
+
+        const T *operator->() { return get().get(); }
+
+    private:
+        void refresh() { snapshot_ = src_->acquire(version_); }
+
+        const atomic_shared_ptr *src_;
+        value_type snapshot_;
+        uint64_t version_ = 0;
+    };
+
+private:
+    struct node {
+        node(value_type v, uint64_t ver) : value(std::move(v)), version(ver) {}
+
+        value_type value;
+        uint64_t version;
+        std::atomic<long> internal{0};  // 已经离开的读者数(负数)加上写者转移过来的外部计数
+    };
+
+    static constexpr int count_shift = 48;
+    static constexpr uint64_t one = uint64_t(1) << count_shift;
+    static constexpr uint64_t ptr_mask = one - 1;
+
+    static uint64_t pack(node *n) noexcept { return reinterpret_cast<uintptr_t>(n); }
+
+    static node *unpack(uint64_t w) noexcept { return reinterpret_cast<node *>(w & ptr_mask); }
+
+    static long count(uint64_t w) noexcept { return static_cast<long>(w >> count_shift); }
+
+    value_type acquire(uint64_t &version) const {
+        // 外部计数 +1：在我们离开之前，写者不会释放这个节点
+        node *n = unpack(packed_.fetch_add(one, std::memory_order_acquire));
+        value_type ret = n->value;
+        version = n->version;
+        drop(n);
+        return ret;
+    }
+
+    /**
+     * 离开节点：节点还是当前版本时把外部计数减回去，避免 16 位的外部计数溢出；
+     * 已经被写者换走时外部计数已经转移了，减内部计数。
+     * 我们还持有引用，n 不会被释放，所以比较指针不会有 ABA 问题
+     */
+    void drop(node *n) const {
+        uint64_t w = packed_.load(std::memory_order_relaxed);
+        while (unpack(w) == n) {
+            if (packed_.compare_exchange_weak(w, w - one, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        release(n, -1);
+    }
+
+    // 内部计数加上 delta，回到 0 说明写者已经换走了它并且所有读者都离开了
+    static void release(node *n, long delta) {
+        if (n->internal.fetch_add(delta, std::memory_order_acq_rel) + delta == 0) {
+            delete n;
+        }
+    }
+
+    mutable std::atomic<uint64_t> packed_;
+    std::atomic<uint64_t> version_{0};
+    std::mutex write_m_;
+};
+}; // namespace DD
@@ -0,0 +1,107 @@
+#include "DDconcurrent_map.h"
+
+// 测试
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+using namespace DD;
+
+// 对照组：一个全局互斥量保护的 unordered_map
+struct locked_map {
+    std::optional<long> find(long k) {
+        std::lock_guard<std::mutex> lk(m);
+        auto it = map.find(k);
+        if (it == map.end()) return {};
+        return it->second;
+    }
+
+    void insert_or_assign(long k, long v) {
+        std::lock_guard<std::mutex> lk(m);
+        map.insert_or_assign(k, v);
+    }
+
+    void erase(long k) {
+        std::lock_guard<std::mutex> lk(m);
+        map.erase(k);
+    }
+
+    std::mutex m;
+    std::unordered_map<long, long> map;
+};
+
+// 每个线程执行 ops 次操作，read_percent% 是查找，其余一半插入一半删除，返回总吞吐(百万次/秒)
+template<class Map>
+double bench(Map &map, int nthreads, int ops, int read_percent, long keys) {
+    std::vector<std::thread> threads;
+    auto begin = std::chrono::steady_clock::now();
+    for (int t = 0; t < nthreads; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 rng(t);
+            long hits = 0;
+            for (int i = 0; i < ops; ++i) {
+                long k = rng() % keys;
+                int op = rng() % 100;
+                if (op < read_percent) {
+                    hits += map.find(k).has_value();
+                } else if (op % 2) {
+                    map.insert_or_assign(k, k);
+                } else {
+                    map.erase(k);
+                }
+            }
+            if (hits < 0) std::cout << hits;
+        });
+    }
+    for (auto &t : threads) t.join();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - begin;
+    return double(nthreads) * ops / d.count() / 1e6;
+}
+
+int main() {
+    // 1. 基本操作和渐进式扩容
+    concurrent_map<std::string, int> m(64);
+    for (int i = 0; i < 10000; ++i) {
+        m.insert_or_assign(std::to_string(i), i);
+    }
+    m.compute("42", [](std::optional<int> &v) { *v += 1000; });
+    m.compute("new", [](std::optional<int> &v) { v = 7; });
+    m.erase("0");
+    std::cout << "size " << m.size() << ", buckets " << m.bucket_count() << ", 42 -> " << *m.find("42")
+              << ", new -> " << *m.find("new") << ", 0 found " << m.contains("0") << "\n";
+
+    // 2. 并发读写：所有线程插入后 size 应该等于 key 的个数
+    concurrent_map<long, long> c(64);
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&c, t] {
+                for (long k = t; k < 200000; k += 4) c.insert_or_assign(k, k);
+            });
+        }
+        for (auto &t : threads) t.join();
+    }
+    std::cout << "concurrent inserts: size " << c.size() << ", buckets " << c.bucket_count() << "\n";
+
+    // 3. 读多写少和混合负载
+    const long keys = 100000;
+    const int ops = 200000;
+    for (int read_percent : {95, 50}) {
+        for (int n : {1, 2, 4, 8, 16, 32}) {
+            locked_map a;
+            concurrent_map<long, long> b;
+            for (long k = 0; k < keys; k += 2) {
+                a.insert_or_assign(k, k);
+                b.insert_or_assign(k, k);
+            }
+            double x = bench(a, n, ops, read_percent, keys);
+            double y = bench(b, n, ops, read_percent, keys);
+            std::cout << read_percent << "% reads, " << n << " threads: mutex+unordered_map " << x
+                      << " M ops/s, concurrent_map " << y << " M ops/s\n";
+        }
+    }
+    return 0;
+}
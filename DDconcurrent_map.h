@@ -0,0 +1,279 @@
+#pragma once
+
+// 分段加锁的并发哈希表：写操作按桶所在的段加锁，读操作无锁
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "DDreclaim.h"
+#include "DDvector.h"
+
+namespace DD {
+/**
+ * 1. 锁分段：桶 i 由第 (i % stripes) 把锁保护。桶数和段数都是 2 的幂，
+ *    同一个 key 在新旧两张表中的桶总是落在同一段里，所以扩容时不需要额外的锁。
+ * 2. 无锁读：链表节点一旦发布就不再修改，修改值时换成新节点，
+ *    摘下来的节点交给 epoch_domain 回收，读者在 guard 内遍历链表是安全的。
+ * 3. 渐进式扩容：扩容时只分配新表，旧表的桶由之后的写操作一点点搬过去，
+ *    搬完之前读者会先看旧表中对应的桶是否已经搬走。
+ */
+template<class K, class V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<K>>
+class concurrent_map {
+public:
+    explicit concurrent_map(size_t bucket_count = 1024, epoch_domain &ebr = epoch_domain::global())
+        : ebr_(ebr) {
+        size_t n = stripes;
+        while (n < bucket_count) n <<= 1;
+        table_.store(new table(n), std::memory_order_relaxed);
+    }
+
+    concurrent_map(const concurrent_map &) = delete;
+
+    concurrent_map &operator=(const concurrent_map &) = delete;
+
+    // 析构时不应该再有其他线程访问
+    ~concurrent_map() {
+        table *t = table_.load(std::memory_order_acquire);
+        table *o = old_.load(std::memory_order_acquire);
+        if (o && o != t) delete o;
+        delete t;
+    }
+
+    std::optional<V> find(const K &key) const {
+        size_t h = hash_(key);
+        epoch_domain::guard g(ebr_);
+        if (node *n = search(read_bucket(h), h, key)) {
+            return n->value;
+        }
+        return {};
+    }
+
+    bool contains(const K &key) const { return find(key).has_value(); }
+
+    // 返回 true 表示插入了新元素，false 表示替换了已有的值
+    template<class M>
+    bool insert_or_assign(const K &key, M &&value) {
+        size_t h = hash_(key);
+        epoch_domain::guard g(ebr_);
+        bool inserted;
+        {
+            write_scope w(*this, h);
+            inserted = assign(w.b, h, key, std::forward<M>(value));
+        }
+        if (inserted) grow_if_needed();
+        return inserted;
+    }
+
+    bool erase(const K &key) {
+        size_t h = hash_(key);
+        epoch_domain::guard g(ebr_);
+        write_scope w(*this, h);
+        return remove(w.b, h, key);
+    }
+
+    /**
+     * 在锁内原子地读-改-写：f 接收 std::optional<V>&，不存在时为空；
+     * f 返回后 optional 有值就写回，没有值就删除
+     */
+    template<class F>
+    void compute(const K &key, F f) {
+        size_t h = hash_(key);
+        epoch_domain::guard g(ebr_);
+        bool inserted = false;
+        {
+            write_scope w(*this, h);
+            node *n = search(*w.b, h, key);
+            std::optional<V> v;
+            if (n) v = n->value;
+            f(v);
+            if (v) {
+                inserted = assign(w.b, h, key, std::move(*v));
+            } else if (n) {
+                remove(w.b, h, key);
+            }
+        }
+        if (inserted) grow_if_needed();
+    }
+
+    size_t size() const noexcept { return size_.load(std::memory_order_relaxed); }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    size_t bucket_count() const noexcept { return table_.load(std::memory_order_acquire)->buckets.size(); }
+
+private:
+    static constexpr size_t stripes = 64;
+    static constexpr size_t migrate_step = 16;  // 每次写操作顺便搬运的桶数
+
+    struct node {
+        node(const K &k, V v, size_t h, node *n) : key(k), value(std::move(v)), hash(h), next(n) {}
+
+        const K key;
+        const V value;
+        const size_t hash;
+        std::atomic<node *> next;
+    };
+
+    struct bucket {
+        std::atomic<node *> head{nullptr};
+        std::atomic<bool> migrated{false};  // 只对旧表有意义：已经搬到新表
+    };
+
+    struct table {
+        explicit table(size_t n) : buckets(n), mask(n - 1) {}
+
+        ~table() {
+            for (auto &b : buckets) {
+                node *n = b.head.load(std::memory_order_relaxed);
+                while (n) {
+                    node *next = n->next.load(std::memory_order_relaxed);
+                    delete n;
+                    n = next;
+                }
+            }
+        }
+
+        bucket &at(size_t h) { return buckets[h & mask]; }
+
+        DD::vector<bucket> buckets;
+        size_t mask;
+        std::atomic<size_t> cursor{0};          // 下一个要搬运的桶
+        std::atomic<size_t> migrated_count{0};  // 已经搬完的桶数
+    };
+
+    struct alignas(64) stripe {
+        std::mutex m;
+    };
+
+    // 写操作的准备工作：先帮忙搬运几个桶，再锁住 key 所在的段，保证这个桶已经在新表里
+    struct write_scope {
+        write_scope(concurrent_map &map, size_t h) {
+            map.help_migrate();
+            while (true) {
+                lk = std::unique_lock<std::mutex>(map.locks_[h & (stripes - 1)].m);
+                table *t = map.table_.load(std::memory_order_acquire);
+                table *o = map.old_.load(std::memory_order_acquire);
+                if (o && o != t) {
+                    map.migrate_bucket(o, t, h & o->mask);
+                }
+                b = &t->at(h);
+                // 持有段锁时桶不会被搬走；读到的 t 已经过时并且桶已经搬走时重新来
+                if (!b->migrated.load(std::memory_order_acquire)) return;
+                lk.unlock();
+            }
+        }
+
+        std::unique_lock<std::mutex> lk;
+        bucket *b;
+    };
+
+    // 读者应该看哪个桶：先读 table_ 再读 old_，看到新表就一定能看到旧表
+    bucket &read_bucket(size_t h) const {
+        while (true) {
+            table *t = table_.load(std::memory_order_acquire);
+            table *o = old_.load(std::memory_order_acquire);
+            bucket *b = &t->at(h);
+            if (o && o != t && !o->at(h).migrated.load(std::memory_order_acquire)) {
+                b = &o->at(h);
+            }
+            // t 本身已经变成了旧表并且这个桶被搬走了，重新读
+            if (!b->migrated.load(std::memory_order_acquire)) return *b;
+        }
+    }
+
+    node *search(bucket &b, size_t h, const K &key) const {
+        for (node *n = b.head.load(std::memory_order_acquire); n; n = n->next.load(std::memory_order_acquire)) {
+            if (n->hash == h && eq_(n->key, key)) return n;
+        }
+        return nullptr;
+    }
+
+    // 以下操作都在持有段锁的情况下调用
+    template<class M>
+    bool assign(bucket *b, size_t h, const K &key, M &&value) {
+        std::atomic<node *> *link = &b->head;
+        for (node *n = link->load(std::memory_order_relaxed); n; n = link->load(std::memory_order_relaxed)) {
+            if (n->hash == h && eq_(n->key, key)) {
+                // 不能原地修改，读者可能正在拷贝旧值
+                node *fresh = new node(key, V(std::forward<M>(value)), h, n->next.load(std::memory_order_relaxed));
+                link->store(fresh, std::memory_order_release);
+                ebr_.retire(n);
+                return false;
+            }
+            link = &n->next;
+        }
+        b->head.store(new node(key, V(std::forward<M>(value)), h, b->head.load(std::memory_order_relaxed)),
+                      std::memory_order_release);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool remove(bucket *b, size_t h, const K &key) {
+        std::atomic<node *> *link = &b->head;
+        for (node *n = link->load(std::memory_order_relaxed); n; n = link->load(std::memory_order_relaxed)) {
+            if (n->hash == h && eq_(n->key, key)) {
+                link->store(n->next.load(std::memory_order_relaxed), std::memory_order_release);
+                ebr_.retire(n);
+                size_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            link = &n->next;
+        }
+        return false;
+    }
+
+    // 把旧表的第 i 个桶复制到新表，旧链表保持不变，留给还在读旧表的读者
+    void migrate_bucket(table *o, table *t, size_t i) {
+        bucket &ob = o->buckets[i];
+        if (ob.migrated.load(std::memory_order_relaxed)) return;
+        for (node *n = ob.head.load(std::memory_order_relaxed); n; n = n->next.load(std::memory_order_relaxed)) {
+            bucket &nb = t->at(n->hash);
+            nb.head.store(new node(n->key, n->value, n->hash, nb.head.load(std::memory_order_relaxed)),
+                          std::memory_order_release);
+        }
+        ob.migrated.store(true, std::memory_order_release);
+        if (o->migrated_count.fetch_add(1, std::memory_order_acq_rel) + 1 == o->buckets.size()) {
+            // 全部搬完：旧表交给 epoch_domain，等读者离开后释放
+            old_.store(nullptr, std::memory_order_release);
+            ebr_.retire(o);
+        }
+    }
+
+    // 领取几个还没搬运的桶，逐个加对应的段锁搬运
+    void help_migrate() {
+        table *t = table_.load(std::memory_order_acquire);
+        table *o = old_.load(std::memory_order_acquire);
+        if (!o || o == t) return;
+        for (size_t k = 0; k < migrate_step; ++k) {
+            size_t i = o->cursor.fetch_add(1, std::memory_order_relaxed);
+            if (i >= o->buckets.size()) break;
+            std::lock_guard<std::mutex> lk(locks_[i & (stripes - 1)].m);
+            migrate_bucket(o, t, i);
+        }
+    }
+
+    // 负载因子超过 1 时开始扩容：只分配新表并发布，不搬运任何数据
+    void grow_if_needed() {
+        table *t = table_.load(std::memory_order_acquire);
+        if (size() <= t->buckets.size() || old_.load(std::memory_order_acquire)) return;
+
+        std::unique_lock<std::mutex> lk(resize_m_, std::try_to_lock);
+        if (!lk.owns_lock() || old_.load(std::memory_order_acquire) || table_.load() != t) return;
+        table *next = new table(t->buckets.size() * 2);
+        old_.store(t, std::memory_order_release);
+        table_.store(next, std::memory_order_release);
+    }
+
+    std::atomic<table *> table_{nullptr};
+    std::atomic<table *> old_{nullptr};     // 正在搬运的旧表
+    std::atomic<size_t> size_{0};
+    std::array<stripe, stripes> locks_;
+    std::mutex resize_m_;
+    epoch_domain &ebr_;
+    Hash hash_;
+    KeyEqual eq_;
+};
+}; // namespace DD
@@ -0,0 +1,115 @@
+#include "DDflat_map.h"
+
+// 测试：先和 std::unordered_map 对拍，再比较插入、命中查找、未命中查找和迭代的速度
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+using namespace DD;
+
+using steady = std::chrono::steady_clock;
+
+// 支持异构查找的字符串哈希
+struct string_hash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+// 防止编译器把查找结果优化掉
+volatile uint64_t sink;
+
+template<class F>
+double ns_per_op(size_t n, F f) {
+    auto begin = steady::now();
+    f();
+    return std::chrono::duration<double, std::nano>(steady::now() - begin).count() / double(n);
+}
+
+template<class Map>
+void bench(const char *name, const std::vector<uint64_t> &keys, const std::vector<uint64_t> &misses) {
+    size_t n = keys.size();
+    Map m;
+    double ins = ns_per_op(n, [&] {
+        for (auto k : keys) m[k] = k;
+    });
+    double hit = ns_per_op(n, [&] {
+        uint64_t s = 0;
+        for (auto k : keys) s += m.find(k)->second;
+        sink = s;
+    });
+    double miss = ns_per_op(n, [&] {
+        uint64_t s = 0;
+        for (auto k : misses) s += m.find(k) == m.end();
+        sink = s;
+    });
+    double iter = ns_per_op(n, [&] {
+        uint64_t s = 0;
+        for (auto &e : m) s += e.second;
+        sink = s;
+    });
+    std::cout << "  " << name << ": insert " << ins << " ns, hit " << hit << " ns, miss " << miss << " ns, iterate "
+              << iter << " ns\n";
+}
+
+int main(int argc, char **argv) {
+    // 1. 和 std::unordered_map 对拍：随机插入、覆盖、删除
+    {
+        flat_map<int, int> a;
+        std::unordered_map<int, int> b;
+        std::mt19937 rng(42);
+        bool ok = true;
+        for (int i = 0; i < 500000; ++i) {
+            int k = int(rng() % 20000), op = int(rng() % 3);
+            if (op == 0) {
+                a.insert_or_assign(k, i);
+                b.insert_or_assign(k, i);
+            } else if (op == 1) {
+                ok &= a.erase(k) == b.erase(k);
+            } else {
+                auto it = a.find(k);
+                auto jt = b.find(k);
+                ok &= (it == a.end()) == (jt == b.end()) && (it == a.end() || it->second == jt->second);
+            }
+        }
+        ok &= a.size() == b.size();
+        for (auto &e : a) ok &= b.count(e.first) && b[e.first] == e.second;
+        std::cout << "random ops against std::unordered_map: " << (ok ? "ok" : "MISMATCH") << ", size " << a.size()
+                  << "\n";
+    }
+
+    // 2. 异构查找：用 string_view / const char* 查，不构造临时 string
+    {
+        flat_map<std::string, int, string_hash, std::equal_to<>> m;
+        m["alpha"] = 1;
+        m["beta"] = 2;
+        std::string_view sv = "beta";
+        std::cout << "heterogeneous lookup: " << m.find(sv)->second << " " << m.contains("gamma") << "\n";
+    }
+
+    // 3. reserve 之后插入不会重建索引
+    {
+        flat_map<uint64_t, uint64_t> m;
+        m.reserve(100000);
+        size_t cap = m.capacity();
+        for (uint64_t i = 0; i < 100000; ++i) m[i] = i;
+        std::cout << "reserve(100000): capacity unchanged after inserts: " << (cap == m.capacity()) << "\n";
+    }
+
+    // 4. 性能：默认最多 1e7 个元素，可以用参数加大到 1e8(需要十几 GB 内存)
+    size_t max_n = argc > 1 ? size_t(std::atof(argv[1])) : 10000000;
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+        std::mt19937_64 rng(n);
+        std::vector<uint64_t> keys(n), misses(n);
+        for (auto &k : keys) k = rng() | 1;     // 命中的 key 是奇数，未命中的是偶数
+        for (auto &k : misses) k = rng() & ~uint64_t(1);
+        std::cout << n << " entries:\n";
+        bench<std::unordered_map<uint64_t, uint64_t>>("std::unordered_map", keys, misses);
+        bench<flat_map<uint64_t, uint64_t>>("DD::flat_map      ", keys, misses);
+    }
+    return 0;
+}
@@ -0,0 +1,277 @@
+#pragma once
+
+// 开放寻址的扁平哈希表：元素连续存放在 DD::vector 里，按 16 字节一组的控制字节做 SIMD 探测
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "DDvector.h"
+
+namespace DD {
+/**
+ * 1. 元素按插入顺序连续存放在 entries_ 里，迭代就是顺序扫一遍数组；
+ *    删除时把最后一个元素搬到空出来的位置(所以删除会让指向最后一个元素的迭代器失效)。
+ * 2. 索引表由 64 字节(一个缓存行)的 chunk 组成，每个 chunk 有 12 个槽：
+ *    12 个标签字节(哈希值的高 7 位，最高位置 1 表示占用，0 表示空)和 12 个元素下标。
+ *    查找时用 SSE2 一次比较一个 chunk 的全部标签，只有标签相同的槽才去比较 key，
+ *    一次命中查找一般只碰两个缓存行：chunk 和元素本身。
+ * 3. 每个 chunk 记录有多少元素因为它满了而探测到后面的 chunk(overflow)。
+ *    查找遇到 overflow 为 0 的 chunk 就可以停止，删除时沿探测路径把计数减回去，
+ *    所以不需要墓碑，删除再多也不会让查找变慢。计数到 255 后不再变化(只会多探测，不会出错)，重建索引时清零。
+ * 4. Hash 和 KeyEqual 都有 is_transparent 时，find / contains / count / erase 接受任何可比较的类型(比如用 string_view 查 string)。
+ * 元素类型是 std::pair<K, V>，迭代时不要修改 first。
+ */
+template<class K, class V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<K>>
+class flat_map {
+public:
+    using value_type = std::pair<K, V>;
+    using iterator = value_type *;
+    using const_iterator = const value_type *;
+
+    flat_map() = default;
+
+    explicit flat_map(size_t n) { reserve(n); }
+
+    size_t size() const noexcept { return entries_.size(); }
+
+    bool empty() const noexcept { return entries_.empty(); }
+
+    // 不再重建索引就能放下的元素个数
+    size_t capacity() const noexcept { return chunks_.size() * max_per_chunk; }
+
+    iterator begin() noexcept { return entries_.begin(); }
+
+    iterator end() noexcept { return entries_.end(); }
+
+    const_iterator begin() const noexcept { return entries_.begin(); }
+
+    const_iterator end() const noexcept { return entries_.end(); }
+
+    // 保证之后插入到 n 个元素都不会重建索引，也不会搬移元素
+    void reserve(size_t n) {
+        if (n > capacity()) rehash(n);
+        entries_.reserve(n);
+    }
+
+    void clear() noexcept {
+        entries_.clear();
+        for (auto &c : chunks_) c = chunk{};
+    }
+
+    iterator find(const K &key) { return find_impl(key); }
+
+    const_iterator find(const K &key) const { return const_cast<flat_map *>(this)->find_impl(key); }
+
+    template<class Q, class H = Hash, class E = KeyEqual, class = typename H::is_transparent, class = typename E::is_transparent>
+    iterator find(const Q &key) { return find_impl(key); }
+
+    template<class Q, class H = Hash, class E = KeyEqual, class = typename H::is_transparent, class = typename E::is_transparent>
+    const_iterator find(const Q &key) const { return const_cast<flat_map *>(this)->find_impl(key); }
+
+    bool contains(const K &key) const { return find(key) != end(); }
+
+    template<class Q, class H = Hash, class E = KeyEqual, class = typename H::is_transparent, class = typename E::is_transparent>
+    bool contains(const Q &key) const { return find(key) != end(); }
+
+    size_t count(const K &key) const { return contains(key) ? 1 : 0; }
+
+    template<class Q, class H = Hash, class E = KeyEqual, class = typename H::is_transparent, class = typename E::is_transparent>
+    size_t count(const Q &key) const { return contains(key) ? 1 : 0; }
+
+    // key 不存在时用 args 构造值；返回元素和是否插入了新元素
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(const K &key, Args &&... args) {
+        return emplace_impl(key, [&] {
+            entries_.emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
+                                  std::forward_as_tuple(std::forward<Args>(args)...));
+        });
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(K &&key, Args &&... args) {
+        return emplace_impl(key, [&] {
+            entries_.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                  std::forward_as_tuple(std::forward<Args>(args)...));
+        });
+    }
+
+    std::pair<iterator, bool> insert(const value_type &v) { return try_emplace(v.first, v.second); }
+
+    std::pair<iterator, bool> insert(value_type &&v) { return try_emplace(std::move(v.first), std::move(v.second)); }
+
+    template<class M>
+    std::pair<iterator, bool> insert_or_assign(const K &key, M &&value) {
+        auto r = try_emplace(key, std::forward<M>(value));
+        if (!r.second) r.first->second = std::forward<M>(value);
+        return r;
+    }
+
+    V &operator[](const K &key) { return try_emplace(key).first->second; }
+
+    V &operator[](K &&key) { return try_emplace(std::move(key)).first->second; }
+
+    size_t erase(const K &key) { return erase_impl(key); }
+
+    template<class Q, class H = Hash, class E = KeyEqual, class = typename H::is_transparent, class = typename E::is_transparent>
+    size_t erase(const Q &key) { return erase_impl(key); }
+
+private:
+    static constexpr size_t slots = 12;
+    static constexpr size_t max_per_chunk = 10;     // 平均每个 chunk 最多放 10 个，负载因子约 0.83
+    static constexpr unsigned slot_mask = (1u << slots) - 1;
+
+    struct alignas(64) chunk {
+        uint8_t tags[slots] = {};
+        uint8_t unused[3] = {};
+        uint8_t overflow = 0;
+        uint32_t index[slots] = {};
+
+        // 标签等于 tag 的槽组成的位图；tag 为 0 时就是空槽
+        unsigned match(uint8_t tag) const {
+#if defined(__SSE2__)
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tags));
+            unsigned m = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(char(tag)))));
+            return m & slot_mask;
+#else
+            unsigned m = 0;
+            for (size_t i = 0; i < slots; ++i) {
+                if (tags[i] == tag) m |= 1u << i;
+            }
+            return m;
+#endif
+        }
+    };
+
+    static_assert(sizeof(chunk) == 64, "a chunk should fill exactly one cache line");
+
+    // 探测的起点、标签和步长；步长是奇数，chunk 数是 2 的幂，所以会走遍所有 chunk
+    struct probe {
+        size_t home;
+        uint8_t tag;
+        size_t step;
+    };
+
+    template<class Q>
+    probe make_probe(const Q &key) const {
+        // std::hash 对整数是恒等映射，先打散再取位
+        uint64_t x = uint64_t(hash_(key));
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        uint8_t tag = uint8_t(0x80 | (x >> 57));
+        return probe{size_t(x) & mask_, tag, size_t(tag) * 2 + 1};
+    }
+
+    // 找到 key 所在的 chunk 和槽；没有时 slot 为 slots
+    template<class Q>
+    std::pair<size_t, size_t> locate(const Q &key, const probe &p) const {
+        size_t i = p.home;
+        for (size_t n = 0; n < chunks_.size(); ++n) {
+            const chunk &c = chunks_[i];
+            for (unsigned m = c.match(p.tag); m; m &= m - 1) {
+                size_t s = size_t(__builtin_ctz(m));
+                if (eq_(entries_[c.index[s]].first, key)) return {i, s};
+            }
+            if (c.overflow == 0) break;
+            i = (i + p.step) & mask_;
+        }
+        return {0, slots};
+    }
+
+    template<class Q>
+    iterator find_impl(const Q &key) {
+        if (entries_.empty()) return end();
+        auto [i, s] = locate(key, make_probe(key));
+        return s == slots ? end() : entries_.begin() + chunks_[i].index[s];
+    }
+
+    template<class Construct>
+    std::pair<iterator, bool> emplace_impl(const K &key, Construct construct) {
+        if (!entries_.empty()) {
+            probe p = make_probe(key);
+            auto [i, s] = locate(key, p);
+            if (s != slots) return {entries_.begin() + chunks_[i].index[s], false};
+        }
+        if (size() + 1 > capacity()) rehash(std::max(size() * 2, size_t(max_per_chunk)));
+        size_t idx = size();
+        construct();
+        place(make_probe(entries_[idx].first), uint32_t(idx));
+        return {entries_.begin() + idx, true};
+    }
+
+    // 在探测路径上第一个有空槽的 chunk 里登记下标 idx，路过的满 chunk 的 overflow 加一
+    void place(const probe &p, uint32_t idx) {
+        size_t i = p.home;
+        while (true) {
+            chunk &c = chunks_[i];
+            if (unsigned e = c.match(0)) {
+                size_t s = size_t(__builtin_ctz(e));
+                c.tags[s] = p.tag;
+                c.index[s] = idx;
+                return;
+            }
+            if (c.overflow != 255) ++c.overflow;
+            i = (i + p.step) & mask_;
+        }
+    }
+
+    template<class Q>
+    size_t erase_impl(const Q &key) {
+        if (entries_.empty()) return 0;
+        probe p = make_probe(key);
+        auto [i, s] = locate(key, p);
+        if (s == slots) return 0;
+        unlink(p, i, s);
+
+        size_t idx = chunks_[i].index[s], last = size() - 1;
+        if (idx != last) {
+            // 最后一个元素搬到 idx，改掉指向它的下标
+            index_of(make_probe(entries_[last].first), uint32_t(last)) = uint32_t(idx);
+            entries_[idx] = std::move(entries_[last]);
+        }
+        entries_.pop_back();
+        return 1;
+    }
+
+    // 探测路径上下标为 idx 的槽(一定存在)
+    uint32_t &index_of(const probe &p, uint32_t idx) {
+        for (size_t i = p.home;; i = (i + p.step) & mask_) {
+            chunk &c = chunks_[i];
+            for (unsigned m = c.match(p.tag); m; m &= m - 1) {
+                size_t s = size_t(__builtin_ctz(m));
+                if (c.index[s] == idx) return c.index[s];
+            }
+        }
+    }
+
+    // 清掉 chunk i 的槽 s，并把探测路径上之前的 chunk 的 overflow 减回去
+    void unlink(const probe &p, size_t i, size_t s) {
+        chunks_[i].tags[s] = 0;
+        for (size_t j = p.home; j != i; j = (j + p.step) & mask_) {
+            if (chunks_[j].overflow != 255) --chunks_[j].overflow;
+        }
+    }
+
+    // 重建索引，使之至少能放 n 个元素；元素本身不动
+    void rehash(size_t n) {
+        size_t count = 1;
+        while (count * max_per_chunk < n) count <<= 1;
+        chunks_ = DD::vector<chunk>(count);
+        mask_ = count - 1;
+        for (size_t i = 0; i < entries_.size(); ++i) place(make_probe(entries_[i].first), uint32_t(i));
+    }
+
+    DD::vector<value_type> entries_;
+    DD::vector<chunk> chunks_;
+    size_t mask_ = 0;
+    Hash hash_;
+    KeyEqual eq_;
+};
+}; // namespace DD
@@ -0,0 +1,127 @@
+#include "DDintrusive_ptr.h"
+#include "DDshared_ptr.h"
+
+// 测试
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+using namespace DD;
+
+// 用 perf_event_open 统计缓存未命中次数，没有权限时返回 -1
+class cache_miss_counter {
+public:
+    cache_miss_counter() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        fd_ = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    ~cache_miss_counter() { if (fd_ >= 0) close(fd_); }
+
+    void start() {
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    long long stop() {
+        if (fd_ < 0) return -1;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        long long n = 0;
+        return read(fd_, &n, sizeof(n)) == sizeof(n) ? n : -1;
+    }
+
+private:
+    int fd_;
+};
+
+struct node : ref_counted<node> {
+    explicit node(int v) : value(v) {}
+
+    int value;
+    char payload[48];
+};
+
+struct plain_node {
+    explicit plain_node(int v) : value(v) {}
+
+    int value;
+    char payload[48];
+};
+
+// 按值传递：每次调用都要拷贝一次指针（计数加一、减一）
+template<class Ptr>
+__attribute__((noinline)) int use(Ptr p) { return p->value; }
+
+// 把指针打乱顺序，按值传给 use()，模拟热路径上到处传递对象
+template<class Ptr>
+void bench(const char *name, std::vector<Ptr> ptrs) {
+    std::shuffle(ptrs.begin(), ptrs.end(), std::mt19937(1));
+    cache_miss_counter counter;
+    long sum = 0;
+    counter.start();
+    auto begin = std::chrono::steady_clock::now();
+    for (int round = 0; round < 10; ++round) {
+        for (const auto &p : ptrs) {
+            sum += use(p);
+        }
+    }
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - begin;
+    long long misses = counter.stop();
+    std::cout << name << ": sizeof=" << sizeof(Ptr) << " " << d.count() / (10.0 * ptrs.size()) << " ns/copy, "
+              << "cache misses=" << (misses < 0 ? std::string("n/a") : std::to_string(misses)) << " (sum " << sum << ")\n";
+}
+
+int main() {
+    // 1. 基本用法
+    auto p = make_intrusive<node>(1);
+    {
+        auto q = p;
+        std::cout << "use_count: " << p->use_count() << "\n";
+    }
+    std::cout << "use_count: " << p->use_count() << "\n";
+
+    // 2. 从 unique_ptr 接管
+    auto u = make_unique<node>(2);
+    intrusive_ptr<node> from_unique(std::move(u));
+    std::cout << "from unique_ptr: " << from_unique->value << " use_count " << from_unique->use_count()
+              << " unique_ptr empty " << !u << "\n";
+
+    // 3. 单线程对象可以用非原子计数
+    struct local_node : ref_counted<local_node, single_thread> {
+        int value = 3;
+    };
+    intrusive_ptr<local_node> local(new local_node);
+    std::cout << "single_thread: " << local->value << "\n";
+
+    // 4. 按值传递的开销和缓存未命中：对象数量远大于缓存
+    const int n = 1 << 20;
+    {
+        std::vector<shared_ptr<plain_node>> v;
+        for (int i = 0; i < n; ++i) v.emplace_back(new plain_node(i));
+        bench("shared_ptr(new T)", std::move(v));
+    }
+    {
+        std::vector<shared_ptr<plain_node>> v;
+        for (int i = 0; i < n; ++i) v.push_back(make_shared<plain_node>(i));
+        bench("make_shared      ", std::move(v));
+    }
+    {
+        std::vector<intrusive_ptr<node>> v;
+        for (int i = 0; i < n; ++i) v.push_back(make_intrusive<node>(i));
+        bench("intrusive_ptr    ", std::move(v));
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <utility>
+
+#include "DDref_count.h"
+#include "DDunique_ptr.h"
+
+namespace DD {
+/**
+ * 侵入式引用计数基类(CRTP)：计数直接放在对象里面，和对象的热点数据在同一块内存中。
+ * Policy 在编译期决定计数是否是原子的
+ */
+template<class Derived, class Policy = thread_safe>
+class ref_counted {
+public:
+    int use_count() const noexcept { return count_.use_count(); }
+
+protected:
+    ref_counted() noexcept = default;
+
+    // 拷贝对象时不拷贝计数：新对象还没有被任何 intrusive_ptr 引用
+    ref_counted(const ref_counted &) noexcept {}
+
+    ref_counted &operator=(const ref_counted &) noexcept { return *this; }
+
+    ~ref_counted() = default;
+
+private:
+    // intrusive_ptr 通过 ADL 找到这两个函数
+    friend void intrusive_add_ref(const ref_counted *p) noexcept { p->count_.inc_ref(); }
+
+    friend void intrusive_release(const ref_counted *p) noexcept {
+        if (p->count_.dec_ref() == 0) {
+            delete static_cast<const Derived *>(p);
+        }
+    }
+
+    // 对象刚创建时没有引用，由第一个 intrusive_ptr 加到 1
+    mutable ref_count<Policy> count_{0};
+};
+
+// 侵入式智能指针：只有一个指针大小，计数由对象自己管理
+template<class T>
+class intrusive_ptr {
+public:
+    constexpr intrusive_ptr() noexcept = default;
+
+    constexpr intrusive_ptr(std::nullptr_t) noexcept: intrusive_ptr() {}
+
+    // add_ref 为 false 时接管一个已经被计数过的引用
+    explicit intrusive_ptr(T *ptr, bool add_ref = true) noexcept: ptr_(ptr) {
+        if (ptr_ && add_ref) {
+            intrusive_add_ref(ptr_);
+        }
+    }
+
+    // 从 unique_ptr 接管对象：unique_ptr 放弃所有权之后由计数管理
+    template<class U>
+    intrusive_ptr(unique_ptr<U> &&rhs) noexcept: intrusive_ptr(rhs.release()) {}
+
+    intrusive_ptr(const intrusive_ptr &rhs) noexcept: intrusive_ptr(rhs.ptr_) {}
+
+    intrusive_ptr(intrusive_ptr &&rhs) noexcept: ptr_(std::exchange(rhs.ptr_, nullptr)) {}
+
+    ~intrusive_ptr() noexcept {
+        if (ptr_) {
+            intrusive_release(ptr_);
+        }
+    }
+
+    intrusive_ptr &operator=(const intrusive_ptr &rhs) noexcept {
+        intrusive_ptr(rhs).swap(*this);
+        return *this;
+    }
+
+    intrusive_ptr &operator=(intrusive_ptr &&rhs) noexcept {
+        intrusive_ptr(std::move(rhs)).swap(*this);
+        return *this;
+    }
+
+    void swap(intrusive_ptr &rhs) noexcept { std::swap(ptr_, rhs.ptr_); }
+
+    void reset() noexcept { intrusive_ptr().swap(*this); }
+
+    void reset(T *ptr) noexcept { intrusive_ptr(ptr).swap(*this); }
+
+    // 放弃所有权但不减少计数，返回裸指针
+    T *detach() noexcept { return std::exchange(ptr_, nullptr); }
+
+    T *get() const noexcept { return ptr_; }
+
+    T &operator*() const noexcept { return *ptr_; }
+
+    T *operator->() const noexcept { return ptr_; }
+
+    explicit operator bool() const noexcept { return static_cast<bool>(ptr_); }
+
+private:
+    T *ptr_ = nullptr;
+};
+
+template<class T, class... Args>
+intrusive_ptr<T> make_intrusive(Args &&... args) {
+    return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+}; // namespace DD
@@ -0,0 +1,136 @@
+#include "DDlogger.h"
+
+// 测试：每次写日志增加的延迟，和 std::cout << ... << std::endl 比较
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include "DDthreadpool.h"
+using namespace DD;
+
+using steady = std::chrono::steady_clock;
+
+struct latency {
+    double p50, p99, p999, max;
+};
+
+// 每个线程写 n 条，逐条计时
+template<class F>
+latency measure(int nthreads, int n, F log_one) {
+    std::vector<std::vector<int64_t>> samples(nthreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; ++t) {
+        threads.emplace_back([&, t] {
+            auto &s = samples[t];
+            s.reserve(n);
+            for (int i = 0; i < n; ++i) {
+                auto begin = steady::now();
+                log_one(t, i);
+                s.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(steady::now() - begin).count());
+            }
+        });
+    }
+    for (auto &t : threads) t.join();
+    std::vector<int64_t> all;
+    for (auto &s : samples) all.insert(all.end(), s.begin(), s.end());
+    std::sort(all.begin(), all.end());
+    auto at = [&](double q) { return double(all[size_t(q * double(all.size() - 1))]); };
+    return latency{at(0.5), at(0.99), at(0.999), double(all.back())};
+}
+
+void print(const char *name, const latency &l) {
+    std::cout << "  " << name << ": p50 " << l.p50 << " ns, p99 " << l.p99 << " ns, p99.9 " << l.p999
+              << " ns, max " << l.max << " ns\n";
+}
+
+// 线程池里每个任务写一行日志，返回每秒完成的任务数
+template<class F>
+double pool_throughput(int tasks, F log_one) {
+    thread_pool pool(1024);
+    pool.start(4);
+    std::atomic<int> done{0};
+    auto begin = steady::now();
+    for (int i = 0; i < tasks; ++i) {
+        pool.submit([&, i] {
+            log_one(0, i);
+            done.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    while (done.load() < tasks) std::this_thread::yield();
+    std::chrono::duration<double> d = steady::now() - begin;
+    return tasks / d.count();
+}
+
+int main() {
+    const char *path = "DDlogger_test.log";
+    const char *cout_path = "DDlogger_cout.log";
+
+    // 1. 基本用法
+    {
+        logger log(path);
+        std::string name = "worker";
+        log.info("hello {} #{} pi={} ok={} ptr={}", name, 42, 3.14159, true, static_cast<void *>(nullptr));
+        log.set_level(log_level::info);
+        log.debug("filtered out");
+        log.warn("{} args, {} placeholders", 1);
+        log.flush();
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) std::cout << line << "\n";
+    }
+    std::remove(path);
+
+    // 2. 每次调用的延迟；cout 的 rdbuf 换成文件，和池子里 std::endl 的开销一样。
+    // 换成文件以后 cout 不再有 stdio 的锁，自己加一把，相当于 stdout 的全局锁
+    static std::mutex cout_m;
+    const int n = 100000;
+    std::ofstream file(cout_path);
+    std::streambuf *old = std::cout.rdbuf();
+    for (int threads : {1, 4}) {
+        std::cout << threads << " threads, " << n << " calls each:\n";
+        latency c, d, b;
+        {
+            std::cout.rdbuf(file.rdbuf());
+            c = measure(threads, n, [](int t, int i) {
+                std::lock_guard<std::mutex> lk(cout_m);
+                std::cout << "T" << t << " task " << i << " done in " << 1.5 << " us" << std::endl;
+            });
+            std::cout.rdbuf(old);
+        }
+        {
+            logger log(path, 1 << 16, overflow_policy::drop);
+            d = measure(threads, n, [&](int t, int i) { log.info("T{} task {} done in {} us", t, i, 1.5); });
+            log.flush();
+            std::cout << "  logger(drop) wrote " << log.written_count() << ", dropped " << log.dropped_count() << "\n";
+        }
+        {
+            logger log(path, 1 << 16, overflow_policy::block);
+            b = measure(threads, n, [&](int t, int i) { log.info("T{} task {} done in {} us", t, i, 1.5); });
+            log.flush();
+            std::cout << "  logger(block) wrote " << log.written_count() << ", dropped " << log.dropped_count() << "\n";
+        }
+        print("cout + endl  ", c);
+        print("logger(drop) ", d);
+        print("logger(block)", b);
+    }
+
+    // 3. 线程池吞吐
+    {
+        const int tasks = 200000;
+        std::cout.rdbuf(file.rdbuf());
+        double c = pool_throughput(tasks, [](int, int i) {
+            std::lock_guard<std::mutex> lk(cout_m);
+            std::cout << "task " << i << std::endl;
+        });
+        std::cout.rdbuf(old);
+        logger log(path, 1 << 20, overflow_policy::block);
+        double d = pool_throughput(tasks, [&](int, int i) { log.info("task {}", i); });
+        double none = pool_throughput(tasks, [](int, int) {});
+        std::cout << "pool tasks/s: no logging " << none << ", cout + endl " << c << ", logger " << d << "\n";
+    }
+    file.close();
+    std::remove(path);
+    std::remove(cout_path);
+    return 0;
+}
@@ -0,0 +1,418 @@
+#pragma once
+
+// 异步日志：热路径只把二进制记录写进线程自己的环形缓冲，格式化和写文件都在后台线程
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace DD {
+enum class log_level : uint8_t {
+    debug, info, warn, error
+};
+
+// 线程的缓冲写满时的处理方式
+enum class overflow_policy {
+    drop,   // 丢弃这条记录并计数，调用方永远不等待
+    block   // 等后台线程腾出空间
+};
+
+/**
+ * 格式串只支持 "{}" 占位符，且必须是字符串字面量(记录里只保存指针)。
+ * 参数支持整数、浮点、bool、char、字符串(会被拷贝)和其他指针(按地址输出)。
+ * 每个线程第一次写日志时分到一个单生产者单消费者的环形缓冲，写日志只是一次 memcpy，
+ * 不加锁、不做格式化、不做系统调用；后台线程定期把所有缓冲里的记录取出、格式化，
+ * 用一次 writev 把各个缓冲的输出一起写进文件。
+ *     DD::logger log("app.log");
+ *     log.info("task {} done in {} us", id, us);
+ */
+class logger {
+public:
+    explicit logger(const std::string &path,
+                    size_t buffer_bytes = 1 << 16,
+                    overflow_policy policy = overflow_policy::drop,
+                    std::chrono::milliseconds interval = std::chrono::milliseconds(1))
+            : id_(next_id()), capacity_(round_up(buffer_bytes)), policy_(policy), interval_(interval) {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ < 0) throw std::system_error(errno, std::generic_category(), "DD::logger: open " + path);
+        thread_ = std::thread([this] { run(); });
+    }
+
+    logger(const logger &) = delete;
+
+    logger &operator=(const logger &) = delete;
+
+    // 写完所有已经提交的记录再退出
+    ~logger() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+        ::close(fd_);
+        for (auto &r : rings_) r->closed.store(true, std::memory_order_release);
+    }
+
+    void set_level(log_level l) { level_.store(l, std::memory_order_relaxed); }
+
+    template<class... Args>
+    void log(log_level l, const char *fmt, const Args &... args) {
+        if (l < level_.load(std::memory_order_relaxed)) return;
+        append<stored_t<Args>...>(l, fmt, stored_t<Args>(args)...);
+    }
+
+    template<class... Args>
+    void debug(const char *fmt, const Args &... args) { log(log_level::debug, fmt, args...); }
+
+    template<class... Args>
+    void info(const char *fmt, const Args &... args) { log(log_level::info, fmt, args...); }
+
+    template<class... Args>
+    void warn(const char *fmt, const Args &... args) { log(log_level::warn, fmt, args...); }
+
+    template<class... Args>
+    void error(const char *fmt, const Args &... args) { log(log_level::error, fmt, args...); }
+
+    // 等到调用之前(happens-before)提交的记录都写进文件
+    void flush() {
+        std::unique_lock<std::mutex> lk(m_);
+        uint64_t target = ++flush_requested_;
+        wake_.notify_one();
+        flushed_cv_.wait(lk, [&] { return flushed_ >= target; });
+    }
+
+    uint64_t dropped_count() const { return dropped_.load(std::memory_order_relaxed); }
+
+    uint64_t written_count() const { return written_.load(std::memory_order_relaxed); }
+
+private:
+    // 参数在缓冲里的存储类型
+    template<class T, class D = std::decay_t<T>>
+    using stored_t =
+    std::conditional_t<std::is_same_v<D, bool> || std::is_same_v<D, char>, D,
+    std::conditional_t<std::is_integral_v<D> || std::is_enum_v<D>,
+            std::conditional_t<std::is_signed_v<D>, int64_t, uint64_t>,
+    std::conditional_t<std::is_floating_point_v<D>, double,
+    std::conditional_t<std::is_convertible_v<const D &, std::string_view>, std::string_view,
+    std::conditional_t<std::is_pointer_v<D>, const void *, void>>>>>;
+
+    using formatter = void (*)(const char *fmt, const char *payload, std::string &out);
+
+    struct record_header {
+        uint32_t size;      // 参数部分的字节数
+        log_level level;
+        formatter format;
+        const char *fmt;
+        int64_t time_ns;
+    };
+
+    // 单生产者单消费者的字节环：head_ 只有后台线程写，tail_ 只有所属线程写
+    struct ring {
+        explicit ring(size_t cap, unsigned idx) : data(new char[cap]), capacity(cap), index(idx) {}
+
+        void put(uint64_t pos, const void *src, size_t n) {
+            size_t off = pos & (capacity - 1);
+            size_t first = std::min(n, capacity - off);
+            std::memcpy(data.get() + off, src, first);
+            std::memcpy(data.get(), static_cast<const char *>(src) + first, n - first);
+        }
+
+        void get(uint64_t pos, void *dst, size_t n) const {
+            size_t off = pos & (capacity - 1);
+            size_t first = std::min(n, capacity - off);
+            std::memcpy(dst, data.get() + off, first);
+            std::memcpy(static_cast<char *>(dst) + first, data.get(), n - first);
+        }
+
+        std::unique_ptr<char[]> data;
+        const size_t capacity;
+        const unsigned index;
+        std::atomic<bool> owned{true};     // 线程退出后置 false，缓冲清空后可以给新线程用
+        std::atomic<bool> closed{false};   // logger 已经析构
+        alignas(64) std::atomic<uint64_t> head{0};
+        alignas(64) std::atomic<uint64_t> tail{0};
+    };
+
+    // 线程缓存的 (logger 编号, 缓冲)，线程退出时归还缓冲
+    struct thread_rings {
+        ~thread_rings() {
+            for (auto &e : v) e.second->owned.store(false, std::memory_order_release);
+        }
+
+        std::vector<std::pair<uint64_t, std::shared_ptr<ring>>> v;
+    };
+
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> id{0};
+        return id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static size_t round_up(size_t n) {
+        size_t c = 256;
+        while (c < n) c <<= 1;
+        return c;
+    }
+
+    ring &local_ring() {
+        static thread_local thread_rings tl;
+        for (auto &e : tl.v) {
+            if (e.first == id_) return *e.second;
+        }
+        // 顺便清掉已经析构的 logger 留下的缓冲
+        for (size_t i = 0; i < tl.v.size();) {
+            if (tl.v[i].second->closed.load(std::memory_order_acquire)) {
+                tl.v[i] = std::move(tl.v.back());
+                tl.v.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        tl.v.emplace_back(id_, acquire_ring());
+        return *tl.v.back().second;
+    }
+
+    std::shared_ptr<ring> acquire_ring() {
+        std::lock_guard<std::mutex> lk(m_);
+        for (auto &r : rings_) {
+            if (!r->owned.load(std::memory_order_acquire) &&
+                r->head.load(std::memory_order_acquire) == r->tail.load(std::memory_order_relaxed)) {
+                r->owned.store(true, std::memory_order_relaxed);
+                return r;
+            }
+        }
+        rings_.push_back(std::make_shared<ring>(capacity_, unsigned(rings_.size())));
+        return rings_.back();
+    }
+
+    template<class... S>
+    void append(log_level l, const char *fmt, const S &... args) {
+        size_t need = sizeof(record_header) + (size_t(0) + ... + encoded_size(args));
+        ring &r = local_ring();
+        if (need > r.capacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        uint64_t tail = r.tail.load(std::memory_order_relaxed);
+        while (r.capacity - (tail - r.head.load(std::memory_order_acquire)) < need) {
+            // 缓冲满了说明后台线程跟不上，不等下一个周期，直接叫醒它；
+            // 只有把 drain_requested_ 从 false 改成 true 的那次才通知，缓冲满时的其他调用不进内核
+            if (!drain_requested_.load(std::memory_order_relaxed) &&
+                !drain_requested_.exchange(true, std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lk(m_);     // 后台线程检查条件和睡眠之间不会漏掉这次通知
+                wake_.notify_one();
+            }
+            if (policy_ == overflow_policy::drop) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            std::this_thread::yield();
+        }
+        record_header h{uint32_t(need - sizeof(record_header)), l, &format_record<S...>, fmt,
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::system_clock::now().time_since_epoch()).count()};
+        r.put(tail, &h, sizeof(h));
+        [[maybe_unused]] uint64_t pos = tail + sizeof(h);
+        (encode(r, pos, args), ...);
+        r.tail.store(tail + need, std::memory_order_release);
+    }
+
+    template<class S>
+    static size_t encoded_size(const S &v) {
+        if constexpr (std::is_same_v<S, std::string_view>) return sizeof(uint32_t) + v.size();
+        else return sizeof(S);
+    }
+
+    template<class S>
+    static void encode(ring &r, uint64_t &pos, const S &v) {
+        if constexpr (std::is_same_v<S, std::string_view>) {
+            uint32_t n = uint32_t(v.size());
+            r.put(pos, &n, sizeof(n));
+            r.put(pos + sizeof(n), v.data(), n);
+            pos += sizeof(n) + n;
+        } else {
+            r.put(pos, &v, sizeof(v));
+            pos += sizeof(v);
+        }
+    }
+
+    // 每种参数类型组合实例化一个，后台线程通过记录里的函数指针还原参数
+    template<class... S>
+    static void format_record(const char *fmt, [[maybe_unused]] const char *payload, std::string &out) {
+        (format_arg<S>(fmt, payload, out), ...);
+        out.append(fmt);
+    }
+
+    template<class S>
+    static void format_arg(const char *&fmt, const char *&p, std::string &out) {
+        S v;
+        if constexpr (std::is_same_v<S, std::string_view>) {
+            uint32_t n;
+            std::memcpy(&n, p, sizeof(n));
+            v = std::string_view(p + sizeof(n), n);
+            p += sizeof(n) + n;
+        } else {
+            std::memcpy(&v, p, sizeof(v));
+            p += sizeof(v);
+        }
+        const char *hole = std::strstr(fmt, "{}");
+        if (!hole) return;     // 参数比占位符多，多的丢掉
+        out.append(fmt, hole);
+        fmt = hole + 2;
+        append_value(out, v);
+    }
+
+    template<class S>
+    static void append_value(std::string &out, const S &v) {
+        if constexpr (std::is_same_v<S, std::string_view>) {
+            out.append(v);
+        } else if constexpr (std::is_same_v<S, bool>) {
+            out.append(v ? "true" : "false");
+        } else if constexpr (std::is_same_v<S, char>) {
+            out.push_back(v);
+        } else if constexpr (std::is_same_v<S, const void *>) {
+            char buf[2 + 16] = {'0', 'x'};
+            auto res = std::to_chars(buf + 2, buf + sizeof(buf), reinterpret_cast<uintptr_t>(v), 16);
+            out.append(buf, res.ptr);
+        } else {
+            char buf[32];
+            auto res = std::to_chars(buf, buf + sizeof(buf), v);
+            out.append(buf, res.ptr);
+        }
+    }
+
+    // 一行的格式: 秒.微秒 级别 T线程缓冲号 内容
+    static void format_prefix(std::string &out, const record_header &h, unsigned index) {
+        static const char *names[] = {"DEBUG ", "INFO  ", "WARN  ", "ERROR "};
+        char buf[32];
+        auto res = std::to_chars(buf, buf + sizeof(buf), h.time_ns / 1000000000);
+        out.append(buf, res.ptr);
+        out.push_back('.');
+        int64_t us = h.time_ns / 1000 % 1000000;
+        char frac[6];
+        for (int i = 5; i >= 0; --i, us /= 10) frac[i] = char('0' + us % 10);
+        out.append(frac, 6);
+        out.push_back(' ');
+        out.append(names[size_t(h.level)]);
+        out.push_back('T');
+        res = std::to_chars(buf, buf + sizeof(buf), index);
+        out.append(buf, res.ptr);
+        out.push_back(' ');
+    }
+
+    // 把一个缓冲里现有的记录格式化到 out，返回记录数
+    size_t drain(ring &r, std::string &out) {
+        uint64_t head = r.head.load(std::memory_order_relaxed);
+        uint64_t tail = r.tail.load(std::memory_order_acquire);
+        size_t n = 0;
+        while (head != tail) {
+            record_header h;
+            r.get(head, &h, sizeof(h));
+            scratch_.resize(h.size);
+            r.get(head + sizeof(h), scratch_.data(), h.size);
+            head += sizeof(h) + h.size;
+            // 拷贝出来以后就可以让出空间
+            r.head.store(head, std::memory_order_release);
+            format_prefix(out, h, r.index);
+            h.format(h.fmt, scratch_.data(), out);
+            out.push_back('\n');
+            ++n;
+        }
+        return n;
+    }
+
+    void write_all(std::vector<std::string> &blocks) {
+        std::vector<iovec> iov;
+        for (auto &b : blocks) {
+            if (!b.empty()) iov.push_back(iovec{b.data(), b.size()});
+        }
+        size_t i = 0;
+        while (i < iov.size()) {
+            ssize_t w = ::writev(fd_, iov.data() + i, int(std::min<size_t>(iov.size() - i, IOV_MAX)));
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                return;     // 写失败只能丢掉，不能把错误抛给写日志的线程
+            }
+            // 处理只写了一部分的情况
+            while (i < iov.size() && size_t(w) >= iov[i].iov_len) w -= ssize_t(iov[i++].iov_len);
+            if (i < iov.size()) {
+                iov[i].iov_base = static_cast<char *>(iov[i].iov_base) + w;
+                iov[i].iov_len -= size_t(w);
+            }
+        }
+    }
+
+    void run() {
+        std::vector<ring *> rings;
+        std::vector<std::string> blocks;
+        while (true) {
+            bool stop;
+            uint64_t flush_target;
+            {
+                std::unique_lock<std::mutex> lk(m_);
+                wake_.wait_for(lk, interval_, [&] {
+                    return stop_ || flush_requested_ > flushed_ || drain_requested_.load(std::memory_order_relaxed);
+                });
+                drain_requested_.store(false, std::memory_order_relaxed);
+                stop = stop_;
+                flush_target = flush_requested_;
+                rings.clear();
+                for (auto &r : rings_) rings.push_back(r.get());
+            }
+            blocks.resize(rings.size());
+            size_t n = 0;
+            for (size_t i = 0; i < rings.size(); ++i) {
+                blocks[i].clear();
+                n += drain(*rings[i], blocks[i]);
+            }
+            if (n) {
+                write_all(blocks);
+                written_.fetch_add(n, std::memory_order_relaxed);
+            }
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (flushed_ < flush_target) flushed_ = flush_target;
+            }
+            flushed_cv_.notify_all();
+            if (stop) return;
+        }
+    }
+
+    const uint64_t id_;
+    const size_t capacity_;
+    const overflow_policy policy_;
+    const std::chrono::milliseconds interval_;
+    int fd_;
+    std::atomic<log_level> level_{log_level::debug};
+    alignas(64) std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<bool> drain_requested_{false};  // 有线程的缓冲满了，后台线程应该马上开始一轮
+
+    std::mutex m_;      // 保护 rings_ 和下面的状态，只在注册线程和后台线程每轮开始时用
+    std::condition_variable wake_;
+    std::condition_variable flushed_cv_;
+    std::vector<std::shared_ptr<ring>> rings_;
+    bool stop_ = false;
+    uint64_t flush_requested_ = 0;
+    uint64_t flushed_ = 0;
+
+    std::string scratch_;   // 只有后台线程用
+    std::thread thread_;
+};
+}; // namespace DD
@@ -0,0 +1,87 @@
+#include "DDobject_pool.h"
+
+// 测试
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <malloc.h>     // mallinfo2
+#include <random>
+#include <thread>
+#include <vector>
+using namespace DD;
+
+struct message {
+    explicit message(int i) : id(i) {}
+
+    int id;
+    char payload[60];
+};
+
+// 每个线程反复分配 live 个对象，再按随机顺序释放
+template<class Make>
+double bench(int nthreads, int rounds, int live, Make make) {
+    std::vector<std::thread> threads;
+    auto begin = std::chrono::steady_clock::now();
+    for (int t = 0; t < nthreads; ++t) {
+        threads.emplace_back([=] {
+            std::mt19937 rng(t);
+            using ptr = decltype(make(0));
+            std::vector<ptr> objs;
+            objs.reserve(live);
+            for (int r = 0; r < rounds; ++r) {
+                for (int i = 0; i < live; ++i) {
+                    objs.push_back(make(i));
+                }
+                std::shuffle(objs.begin(), objs.end(), rng);
+                objs.clear();
+            }
+        });
+    }
+    for (auto &t : threads) t.join();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - begin;
+    return double(nthreads) * rounds * live / d.count() / 1e6;
+}
+
+// 按缓存行对齐的类型：chunk 要按 64 字节对齐申请
+struct alignas(64) padded_counter {
+    long value;
+
+    explicit padded_counter(long v) : value(v) {}
+};
+
+int main() {
+    std::cout << "sizeof(unique_ptr<message>) = " << sizeof(unique_ptr<message>)
+              << ", sizeof(pooled_ptr<message>) = " << sizeof(pooled_ptr<message>) << "\n";
+
+    {
+        auto m = make_pooled<message>(1);
+        std::cout << "pooled message id " << m->id << "\n";
+    }
+    {
+        std::vector<pooled_ptr<padded_counter>> counters;
+        bool aligned = true;
+        for (int i = 0; i < 100; ++i) {
+            counters.push_back(make_pooled<padded_counter>(i));
+            aligned = aligned && reinterpret_cast<uintptr_t>(counters.back().get()) % 64 == 0;
+        }
+        std::cout << "over-aligned objects " << (aligned ? "all 64-byte aligned" : "MISALIGNED") << "\n";
+        assert(aligned);
+    }
+
+    const int rounds = 200, live = 4096;
+    for (int n : {1, 2, 4, 8}) {
+        double a = bench(n, rounds, live, [](int i) { return make_unique<message>(i); });
+        double b = bench(n, rounds, live, [](int i) { return make_pooled<message>(i); });
+        std::cout << n << " threads: new/delete " << a << " M alloc+free/s, object_pool " << b << " M alloc+free/s\n";
+    }
+
+    // 碎片：从系统拿到的内存和峰值存活对象占用的内存之比
+    struct mallinfo2 mi = ::mallinfo2();
+    size_t max_live = 8 * live * sizeof(message);   // 8 个线程同时持有 live 个对象
+    std::cout << "max live bytes " << max_live
+              << ", malloc arena bytes " << mi.arena + mi.hblkhd
+              << ", object_pool reserved bytes " << object_pool<message>::instance().reserved_bytes() << "\n";
+    return 0;
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "DDunique_ptr.h"
+
+namespace DD {
+/**
+ * 固定大小的对象池：每种类型 T 一个全局实例。
+ * 每个线程有自己的空闲链表缓存，分配和释放通常不需要加锁；
+ * 缓存空了从中心链表一次取一批，缓存太多时一次还回去一批。
+ * 内存按块(chunk)向系统申请，对象池存在期间不会还给系统。
+ */
+template<class T>
+class object_pool {
+public:
+    static object_pool &instance() {
+        static object_pool pool;
+        return pool;
+    }
+
+    object_pool(const object_pool &) = delete;
+
+    object_pool &operator=(const object_pool &) = delete;
+
+    ~object_pool() {
+        for (void *c : chunks_) {
+            ::operator delete(c, std::align_val_t(alignof(slot)));
+        }
+    }
+
+    // 分配一块能放下 T 的未初始化内存
+    void *allocate() {
+        thread_cache &c = local_cache();
+        if (!c.head) {
+            refill(c);
+        }
+        slot *s = c.head;
+        c.head = s->next;
+        --c.count;
+        return s;
+    }
+
+    void deallocate(void *p) noexcept {
+        thread_cache &c = local_cache();
+        slot *s = static_cast<slot *>(p);
+        s->next = c.head;
+        c.head = s;
+        if (++c.count >= 2 * batch) {
+            flush(c, batch);
+        }
+    }
+
+    template<class... Args>
+    T *create(Args &&... args) {
+        void *p = allocate();
+        try {
+            return ::new(p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(p);
+            throw;
+        }
+    }
+
+    void destroy(T *p) noexcept {
+        p->~T();
+        deallocate(p);
+    }
+
+    // 已经向系统申请的字节数
+    size_t reserved_bytes() {
+        std::lock_guard<std::mutex> lk(m_);
+        return chunks_.size() * chunk_slots * sizeof(slot);
+    }
+
+private:
+    // 空闲时存放链表指针，使用时存放对象
+    union slot {
+        slot *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static constexpr size_t batch = 64;
+    static constexpr size_t chunk_slots = 1024;
+
+    struct thread_cache {
+        object_pool *pool;
+        slot *head = nullptr;
+        size_t count = 0;
+
+        // 线程退出时把缓存的空闲块还给中心链表
+        ~thread_cache() { pool->flush(*this, count); }
+    };
+
+    object_pool() = default;
+
+    thread_cache &local_cache() {
+        static thread_local thread_cache c{this};
+        return c;
+    }
+
+    // 从中心链表取一批，不够时申请新的块
+    void refill(thread_cache &c) {
+        std::lock_guard<std::mutex> lk(m_);
+        if (!free_) {
+            grow();
+        }
+        for (size_t i = 0; i < batch && free_; ++i) {
+            slot *s = free_;
+            free_ = s->next;
+            s->next = c.head;
+            c.head = s;
+            ++c.count;
+        }
+    }
+
+    // 把线程缓存中的 n 个空闲块还给中心链表
+    void flush(thread_cache &c, size_t n) {
+        if (n == 0) return;
+        slot *first = c.head, *last = c.head;
+        for (size_t i = 1; i < n; ++i) {
+            last = last->next;
+        }
+        c.head = last->next;
+        c.count -= n;
+
+        std::lock_guard<std::mutex> lk(m_);
+        last->next = free_;
+        free_ = first;
+    }
+
+    void grow() {
+        // 按 slot 的对齐申请，超过 operator new 默认对齐的 T(比如按缓存行对齐的结构)也能放对位置
+        slot *chunk = static_cast<slot *>(::operator new(chunk_slots * sizeof(slot), std::align_val_t(alignof(slot))));
+        chunks_.push_back(chunk);
+        for (size_t i = 0; i < chunk_slots; ++i) {
+            chunk[i].next = free_;
+            free_ = &chunk[i];
+        }
+    }
+
+    std::mutex m_;
+    slot *free_ = nullptr;          // 中心空闲链表
+    std::vector<void *> chunks_;
+};
+
+// 无状态的删除器：把对象还给对象池，配合 unique_ptr 的空基类优化不占空间
+template<class T>
+struct pool_delete {
+    void operator()(T *p) const noexcept { object_pool<T>::instance().destroy(p); }
+};
+
+template<class T>
+using pooled_ptr = unique_ptr<T, pool_delete<T>>;
+
+template<class T, class... Args>
+pooled_ptr<T> make_pooled(Args &&... args) {
+    return pooled_ptr<T>(object_pool<T>::instance().create(std::forward<Args>(args)...));
+}
+
+}; // namespace DD
@@ -0,0 +1,80 @@
+#include "DDpipeline.h"
+
+// 测试：parse -> transform -> write，模拟一个 transform 比较慢的流水线
+#include <iostream>
+#include <sstream>
+using namespace DD;
+
+struct record {
+    int id;
+    std::string text;
+};
+
+void spin_for(std::chrono::microseconds d) {
+    auto end = std::chrono::steady_clock::now() + d;
+    while (std::chrono::steady_clock::now() < end) {}
+}
+
+// 构造流水线，返回 write 阶段看到的 id 是否严格递增
+bool build_and_run(pipeline &p, int n, thread_pool *pool) {
+    int next = 0;
+    bool in_order = true;
+    int written = 0;
+    p.source<std::string>("read", [&, i = 0]() mutable -> std::optional<std::string> {
+        if (i == n) return {};
+        return std::to_string(i++) + " hello";
+    });
+    p.stage<std::string>("parse", stage_mode::parallel, 2, [](std::string line) {
+        std::istringstream in(line);
+        record r;
+        in >> r.id >> r.text;
+        return r;
+    });
+    p.stage<record>("transform", stage_mode::parallel, 4, [](record r) {
+        spin_for(std::chrono::microseconds(20));
+        for (auto &c : r.text) c = std::toupper(c);
+        return r;
+    });
+    p.sink<record>("write", stage_mode::serial_in_order, 1, [&](record r) {
+        in_order = in_order && r.id == next;
+        ++next;
+        ++written;
+    });
+    if (pool) {
+        p.run(*pool);
+    } else {
+        p.run();
+    }
+    return in_order && written == n;
+}
+
+int main() {
+    const int n = 20000;
+    {
+        pipeline p(16);
+        bool ok = build_and_run(p, n, nullptr);
+        std::cout << "dedicated threads: " << (ok ? "all records written in order" : "ORDER BROKEN") << "\n";
+        p.report(std::cout);
+    }
+    {
+        thread_pool pool(64);
+        pool.start(8);
+        pipeline p(16);
+        bool ok = build_and_run(p, n, &pool);
+        std::cout << "thread_pool workers: " << (ok ? "all records written in order" : "ORDER BROKEN") << "\n";
+        p.report(std::cout);
+    }
+    // 线程不够或者会丢任务的线程池直接拒绝，不会卡住
+    for (auto policy : {overload_policy::block, overload_policy::drop_newest}) {
+        thread_pool pool(64);
+        pool.set_overload_policy(policy);
+        pool.start(policy == overload_policy::block ? 4 : 8);
+        pipeline p(16);
+        try {
+            build_and_run(p, n, &pool);
+        } catch (const std::invalid_argument &e) {
+            std::cout << "rejected: " << e.what() << "\n";
+        }
+    }
+    return 0;
+}
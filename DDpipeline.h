@@ -0,0 +1,311 @@
+#pragma once
+
+// 多阶段并行流水线：阶段之间用有界队列连接，队列满了上游自然会阻塞(背压)
+#include <any>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "DDqueue2.h"
+#include "DDthreadpool.h"
+
+namespace DD {
+enum class stage_mode {
+    serial_in_order,        // 一个线程，按照 source 产生的顺序处理
+    serial_out_of_order,    // 一个线程，按到达的顺序处理
+    parallel,               // 多个线程同时处理
+};
+
+// 一个阶段的运行统计
+struct stage_stats {
+    std::string name;
+    size_t workers = 0;
+    uint64_t items = 0;
+    double busy_ms = 0;         // 所有线程执行用户函数的总时间
+    double input_stall_ms = 0;  // 等待上游(输入队列为空)的总时间
+    double output_stall_ms = 0; // 等待下游(输出队列已满)的总时间
+};
+
+/**
+ * 用法：
+ *     pipeline p(16);
+ *     p.source<std::string>("read", [&]() -> std::optional<std::string> { ... });
+ *     p.stage<std::string>("parse", stage_mode::parallel, 4, [](std::string s) { return parse(s); });
+ *     p.sink<record>("write", stage_mode::serial_in_order, 1, [&](record r) { ... });
+ *     p.run();           // 或 p.run(pool)，在线程池的线程上运行
+ *     p.report(std::cout);
+ * 每个阶段的输入类型需要显式给出，输出类型由函数的返回值推导。
+ * 阶段之间的数据用 std::any 传递，所以必须是可拷贝构造的类型。
+ */
+class pipeline {
+public:
+    explicit pipeline(size_t buffer_size = 16) : buffer_size_(buffer_size) {}
+
+    pipeline(const pipeline &) = delete;
+
+    pipeline &operator=(const pipeline &) = delete;
+
+    // 第一个阶段：f 返回 std::optional<T>，返回空表示数据结束
+    template<class T, class F>
+    pipeline &source(std::string name, F f) {
+        assert(stages_.empty());
+        add(std::move(name), stage_mode::serial_in_order, 1,
+            [f = std::move(f)](std::any &&) mutable -> std::any {
+                std::optional<T> v = f();
+                if (!v) return {};
+                return std::any(std::move(*v));
+            });
+        return *this;
+    }
+
+    template<class In, class F>
+    pipeline &stage(std::string name, stage_mode mode, size_t parallelism, F f) {
+        using Out = std::invoke_result_t<F &, In>;
+        static_assert(!std::is_void_v<Out>, "use sink() for the last stage");
+        add(std::move(name), mode, parallelism, [f = std::move(f)](std::any &&in) mutable -> std::any {
+            return std::any(f(std::any_cast<In &&>(std::move(in))));
+        });
+        return *this;
+    }
+
+    // 最后一个阶段：f 没有返回值
+    template<class In, class F>
+    pipeline &sink(std::string name, stage_mode mode, size_t parallelism, F f) {
+        add(std::move(name), mode, parallelism, [f = std::move(f)](std::any &&in) mutable -> std::any {
+            f(std::any_cast<In &&>(std::move(in)));
+            return {};
+        });
+        return *this;
+    }
+
+    // 为每个阶段的每个线程创建一个专用线程，全部结束后返回
+    void run() {
+        prepare();
+        std::vector<std::thread> threads;
+        for (auto &s : stages_) {
+            for (size_t i = 0; i < s->workers; ++i) {
+                threads.emplace_back([this, st = s.get()] { work(*st); });
+            }
+        }
+        for (auto &t : threads) t.join();
+        finish();
+    }
+
+    /**
+     * 在线程池的线程上运行：每个阶段的每个线程作为一个长时间运行的任务提交。
+     * 线程池的线程数必须不少于所有阶段的线程数之和，否则会因为背压互相等待而死锁；
+     * overload_policy 必须是 block，其他策略会丢掉或者在当前线程执行阶段的线程，run() 永远等不到它们结束。
+     * 不满足时抛出 std::invalid_argument
+     */
+    template<class Mutex>
+    void run(basic_thread_pool<Mutex> &pool) {
+        if (pool.size() < total_workers())
+            throw std::invalid_argument("DD::pipeline: thread pool has fewer threads than the stages' workers");
+        if (pool.policy() != overload_policy::block)
+            throw std::invalid_argument("DD::pipeline: thread pool overload_policy must be block");
+        prepare();
+        std::mutex m;
+        std::condition_variable done;
+        size_t running = total_workers();
+        for (auto &s : stages_) {
+            for (size_t i = 0; i < s->workers; ++i) {
+                pool.submit([&, st = s.get()] {
+                    work(*st);
+                    std::lock_guard<std::mutex> lk(m);
+                    if (--running == 0) done.notify_one();
+                });
+            }
+        }
+        std::unique_lock<std::mutex> lk(m);
+        done.wait(lk, [&] { return running == 0; });
+        finish();
+    }
+
+    std::vector<stage_stats> stats() const {
+        std::vector<stage_stats> out;
+        for (auto &s : stages_) {
+            stage_stats st;
+            st.name = s->name;
+            st.workers = s->workers;
+            st.items = s->items.load();
+            st.busy_ms = s->busy_ns.load() / 1e6;
+            st.input_stall_ms = s->in_stall_ns.load() / 1e6;
+            st.output_stall_ms = s->out_stall_ns.load() / 1e6;
+            out.push_back(st);
+        }
+        return out;
+    }
+
+    /**
+     * 打印每个阶段的吞吐和等待时间。
+     * 利用率 = 执行时间 / (线程数 * 总时间)，利用率最高的阶段就是瓶颈：
+     * 它的上游在等输出(output stall)，下游在等输入(input stall)
+     */
+    void report(std::ostream &os) const {
+        auto all = stats();
+        double wall_s = wall_ns_ / 1e9;
+        size_t bottleneck = 0;
+        auto util = [&](const stage_stats &s) { return wall_s > 0 ? s.busy_ms / 1e3 / (s.workers * wall_s) : 0; };
+        for (size_t i = 1; i < all.size(); ++i) {
+            if (util(all[i]) > util(all[bottleneck])) bottleneck = i;
+        }
+        os << std::left << std::setw(16) << "stage" << std::right << std::setw(8) << "workers"
+           << std::setw(12) << "items" << std::setw(14) << "items/s" << std::setw(8) << "util%"
+           << std::setw(14) << "in stall ms" << std::setw(14) << "out stall ms" << "\n";
+        for (size_t i = 0; i < all.size(); ++i) {
+            auto &s = all[i];
+            os << std::left << std::setw(16) << s.name << std::right << std::setw(8) << s.workers
+               << std::setw(12) << s.items << std::setw(14) << std::fixed << std::setprecision(0)
+               << (wall_s > 0 ? s.items / wall_s : 0) << std::setw(8) << std::setprecision(1) << 100 * util(s)
+               << std::setw(14) << s.input_stall_ms << std::setw(14) << s.output_stall_ms
+               << (i == bottleneck ? "  <- bottleneck" : "") << "\n";
+        }
+    }
+
+private:
+    struct item {
+        size_t seq = 0;
+        std::any value;
+        bool end = false;   // 数据结束标记
+    };
+
+    struct stage_state {
+        std::string name;
+        stage_mode mode;
+        size_t workers;
+        std::function<std::any(std::any &&)> fn;
+        Queue<item> *in = nullptr;      // source 没有输入
+        Queue<item> *out = nullptr;     // sink 没有输出
+        std::atomic<size_t> live{0};    // 还没退出的线程数
+
+        // serial_in_order 的重排缓冲：只有这个阶段唯一的线程访问
+        std::map<size_t, item> pending;
+        size_t next_seq = 0;
+
+        std::atomic<uint64_t> items{0};
+        std::atomic<uint64_t> busy_ns{0};
+        std::atomic<uint64_t> in_stall_ns{0};
+        std::atomic<uint64_t> out_stall_ns{0};
+    };
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void add(std::string name, stage_mode mode, size_t parallelism, std::function<std::any(std::any &&)> fn) {
+        auto s = std::make_unique<stage_state>();
+        s->name = std::move(name);
+        s->mode = mode;
+        s->workers = mode == stage_mode::parallel ? std::max<size_t>(parallelism, 1) : 1;
+        s->fn = std::move(fn);
+        stages_.push_back(std::move(s));
+    }
+
+    size_t total_workers() const {
+        size_t n = 0;
+        for (auto &s : stages_) n += s->workers;
+        return n;
+    }
+
+    // 在相邻的阶段之间创建有界队列
+    void prepare() {
+        assert(stages_.size() >= 2);
+        queues_.clear();
+        for (size_t i = 0; i + 1 < stages_.size(); ++i) {
+            queues_.push_back(std::make_unique<Queue<item>>(buffer_size_, "DD::pipeline buffer"));
+            stages_[i]->out = queues_.back().get();
+            stages_[i + 1]->in = queues_.back().get();
+        }
+        for (auto &s : stages_) {
+            s->live = s->workers;
+            s->pending.clear();
+            s->next_seq = 0;
+        }
+        start_ns_ = now();
+    }
+
+    void finish() { wall_ns_ = now() - start_ns_; }
+
+    void emit(stage_state &s, item &&it) {
+        if (!s.out) return;
+        uint64_t t0 = now();
+        s.out->push(std::move(it));
+        s.out_stall_ns += now() - t0;
+    }
+
+    void process(stage_state &s, item &&it) {
+        uint64_t t0 = now();
+        std::any v = s.fn(std::move(it.value));
+        s.busy_ns += now() - t0;
+        ++s.items;
+        emit(s, item{it.seq, std::move(v), false});
+    }
+
+    void work(stage_state &s) {
+        if (!s.in) {
+            run_source(s);
+            return;
+        }
+        while (true) {
+            uint64_t t0 = now();
+            item it = s.in->pop();
+            s.in_stall_ns += now() - t0;
+
+            if (it.end) {
+                // 让同一阶段的其他线程也看到结束标记，最后一个退出的线程把它传给下游
+                if (--s.live == 0) {
+                    emit(s, std::move(it));
+                } else {
+                    s.in->push(std::move(it));
+                }
+                return;
+            }
+
+            if (s.mode != stage_mode::serial_in_order) {
+                process(s, std::move(it));
+                continue;
+            }
+            // 按序处理：先放进重排缓冲，能接上的依次处理
+            size_t seq = it.seq;
+            s.pending.emplace(seq, std::move(it));
+            for (auto p = s.pending.find(s.next_seq); p != s.pending.end(); p = s.pending.find(s.next_seq)) {
+                process(s, std::move(p->second));
+                s.pending.erase(p);
+                ++s.next_seq;
+            }
+        }
+    }
+
+    void run_source(stage_state &s) {
+        for (size_t seq = 0;; ++seq) {
+            uint64_t t0 = now();
+            std::any v = s.fn(std::any());
+            s.busy_ns += now() - t0;
+            if (!v.has_value()) break;
+            ++s.items;
+            emit(s, item{seq, std::move(v), false});
+        }
+        emit(s, item{0, std::any(), true});
+    }
+
+    size_t buffer_size_;
+    std::vector<std::unique_ptr<stage_state>> stages_;
+    std::vector<std::unique_ptr<Queue<item>>> queues_;
+    uint64_t start_ns_ = 0;
+    uint64_t wall_ns_ = 0;
+};
+}; // namespace DD
@@ -0,0 +1,47 @@
+#include "DDprofiled_mutex.h"
+#include "DDqueue2.h"
+#include "DDthreadpool.h"
+
+// 测试：把 profiled_mutex 作为模板参数传给 Queue 和 thread_pool，运行一段时间后打印报告
+// 也可以不改代码，编译时加 -DDD_PROFILE_LOCKS 替换所有默认的互斥量
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace DD;
+
+int main() {
+    // 1. 一个生产者、两个消费者，共享一个小容量的有界队列
+    Queue<int, profiled_mutex> q(8, "orders queue");
+    std::thread producer([&] {
+        for (int i = 0; i < 200000; ++i) q.push(i);
+        q.push(-1);
+        q.push(-1);
+    });
+    std::vector<std::thread> consumers;
+    for (int t = 0; t < 2; ++t) {
+        consumers.emplace_back([&] {
+            while (q.pop() != -1) {}
+        });
+    }
+    producer.join();
+    for (auto &t : consumers) t.join();
+
+    // 2. 线程池：任务在一个热点锁里做一点工作
+    profiled_mutex stats_m("task stats");
+    long total = 0;
+    {
+        basic_thread_pool<profiled_mutex> pool(16, "worker pool");
+        pool.start(4);
+        for (int i = 0; i < 20000; ++i) {
+            pool.submit([&, i] {
+                std::lock_guard<profiled_mutex> lk(stats_m);
+                total += i;
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    lock_profiler::instance().report(std::cout);
+    return 0;
+}
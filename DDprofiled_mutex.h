@@ -0,0 +1,277 @@
+#pragma once
+
+// 锁竞争分析：带统计的互斥量
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace DD {
+/**
+ * 全局的锁统计表：每个加锁位置(site)有一个名字和一个编号。
+ * 统计数据先记在线程自己的表里，只有所属线程写(不需要原子的读-改-写)，
+ * report() 时再把所有线程的表加起来，所以加锁路径上没有共享的写操作。
+ */
+class lock_profiler {
+public:
+    static constexpr size_t max_sites = 64;     // 超出的位置都记到最后一个里
+    static constexpr size_t buckets = 24;       // 直方图：第 i 个桶是 [2^i, 2^(i+1)) ns
+
+    // 一个加锁位置的汇总结果
+    struct site_report {
+        std::string name;
+        uint64_t acquisitions = 0;
+        uint64_t contended = 0;
+        uint64_t wait_ns = 0;
+        uint64_t hold_ns = 0;
+        std::array<uint64_t, buckets> wait_hist{};
+        std::array<uint64_t, buckets> hold_hist{};
+    };
+
+    static lock_profiler &instance() {
+        static lock_profiler p;
+        return p;
+    }
+
+    // 同名的位置共用一个编号
+    size_t site_id(const char *name) {
+        std::lock_guard<std::mutex> lk(m_);
+        for (size_t i = 0; i < names_.size(); ++i) {
+            if (names_[i] == name) return i;
+        }
+        if (names_.size() == max_sites) return max_sites - 1;
+        names_.emplace_back(name);
+        return names_.size() - 1;
+    }
+
+    void record_acquire(size_t site, bool contended, uint64_t wait_ns) {
+        counters &c = local().sites[site];
+        bump(c.acquisitions, 1);
+        if (contended) {
+            bump(c.contended, 1);
+            bump(c.wait_ns, wait_ns);
+            bump(c.wait_hist[bucket(wait_ns)], 1);
+        }
+    }
+
+    void record_release(size_t site, uint64_t hold_ns) {
+        counters &c = local().sites[site];
+        bump(c.hold_ns, hold_ns);
+        bump(c.hold_hist[bucket(hold_ns)], 1);
+    }
+
+    // 汇总所有线程(包括已经退出的)的统计
+    std::vector<site_report> snapshot() {
+        std::lock_guard<std::mutex> lk(m_);
+        std::vector<site_report> out(names_.size());
+        for (size_t i = 0; i < names_.size(); ++i) {
+            out[i].name = names_[i];
+            add(out[i], retired_.sites[i]);
+            for (thread_block *b : blocks_) {
+                add(out[i], b->sites[i]);
+            }
+        }
+        return out;
+    }
+
+    // 按等待总时间从大到小打印，最热的锁排在最前面
+    void report(std::ostream &os) {
+        auto sites = snapshot();
+        std::sort(sites.begin(), sites.end(),
+                  [](const site_report &a, const site_report &b) { return a.wait_ns > b.wait_ns; });
+        os << std::left << std::setw(28) << "lock site" << std::right
+           << std::setw(12) << "acquire" << std::setw(12) << "contended" << std::setw(10) << "cont%"
+           << std::setw(14) << "wait ms" << std::setw(12) << "wait p99" << std::setw(14) << "hold ms"
+           << std::setw(12) << "hold p99" << "\n";
+        for (auto &s : sites) {
+            os << std::left << std::setw(28) << s.name << std::right
+               << std::setw(12) << s.acquisitions << std::setw(12) << s.contended
+               << std::setw(10) << std::fixed << std::setprecision(2)
+               << (s.acquisitions ? 100.0 * s.contended / s.acquisitions : 0.0)
+               << std::setw(14) << s.wait_ns / 1e6 << std::setw(12) << format_ns(percentile(s.wait_hist, 0.99))
+               << std::setw(14) << s.hold_ns / 1e6 << std::setw(12) << format_ns(percentile(s.hold_hist, 0.99))
+               << "\n";
+        }
+    }
+
+private:
+    struct counters {
+        std::atomic<uint64_t> acquisitions{0};
+        std::atomic<uint64_t> contended{0};
+        std::atomic<uint64_t> wait_ns{0};
+        std::atomic<uint64_t> hold_ns{0};
+        std::array<std::atomic<uint64_t>, buckets> wait_hist{};
+        std::array<std::atomic<uint64_t>, buckets> hold_hist{};
+    };
+
+    struct thread_block {
+        std::array<counters, max_sites> sites;
+    };
+
+    // 线程局部的表：第一次加锁时注册，线程退出时合并到 retired_ 里
+    struct local_handle {
+        lock_profiler *p;
+        thread_block *b;
+
+        ~local_handle() { p->unregister(b); }
+    };
+
+    lock_profiler() = default;
+
+    thread_block &local() {
+        static thread_local local_handle h{this, register_block()};
+        return *h.b;
+    }
+
+    thread_block *register_block() {
+        auto *b = new thread_block;
+        std::lock_guard<std::mutex> lk(m_);
+        blocks_.push_back(b);
+        return b;
+    }
+
+    void unregister(thread_block *b) {
+        std::lock_guard<std::mutex> lk(m_);
+        for (size_t i = 0; i < max_sites; ++i) {
+            merge(retired_.sites[i], b->sites[i]);
+        }
+        blocks_.erase(std::find(blocks_.begin(), blocks_.end(), b));
+        delete b;
+    }
+
+    // 只有所属线程写，用 load + store 代替 fetch_add，避免带 lock 前缀的指令
+    static void bump(std::atomic<uint64_t> &c, uint64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    static size_t bucket(uint64_t ns) {
+        size_t b = ns ? 63 - __builtin_clzll(ns) : 0;
+        return std::min(b, buckets - 1);
+    }
+
+    static void merge(counters &to, const counters &from) {
+        bump(to.acquisitions, from.acquisitions.load(std::memory_order_relaxed));
+        bump(to.contended, from.contended.load(std::memory_order_relaxed));
+        bump(to.wait_ns, from.wait_ns.load(std::memory_order_relaxed));
+        bump(to.hold_ns, from.hold_ns.load(std::memory_order_relaxed));
+        for (size_t i = 0; i < buckets; ++i) {
+            bump(to.wait_hist[i], from.wait_hist[i].load(std::memory_order_relaxed));
+            bump(to.hold_hist[i], from.hold_hist[i].load(std::memory_order_relaxed));
+        }
+    }
+
+    static void add(site_report &to, const counters &from) {
+        to.acquisitions += from.acquisitions.load(std::memory_order_relaxed);
+        to.contended += from.contended.load(std::memory_order_relaxed);
+        to.wait_ns += from.wait_ns.load(std::memory_order_relaxed);
+        to.hold_ns += from.hold_ns.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < buckets; ++i) {
+            to.wait_hist[i] += from.wait_hist[i].load(std::memory_order_relaxed);
+            to.hold_hist[i] += from.hold_hist[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // 返回百分位所在桶的上界
+    static uint64_t percentile(const std::array<uint64_t, buckets> &hist, double q) {
+        uint64_t total = 0;
+        for (auto n : hist) total += n;
+        if (total == 0) return 0;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets; ++i) {
+            seen += hist[i];
+            if (seen >= q * total) return uint64_t(2) << i;
+        }
+        return uint64_t(2) << (buckets - 1);
+    }
+
+    static std::string format_ns(uint64_t ns) {
+        if (ns == 0) return "-";
+        if (ns < 1000) return "<" + std::to_string(ns) + "ns";
+        if (ns < 1000000) return "<" + std::to_string(ns / 1000) + "us";
+        return "<" + std::to_string(ns / 1000000) + "ms";
+    }
+
+    std::mutex m_;
+    std::vector<std::string> names_;
+    std::vector<thread_block *> blocks_;
+    thread_block retired_;      // 已退出线程的统计
+};
+
+// 带统计的互斥量：接口和 std::mutex 一样，可以直接用于 lock_guard / unique_lock
+class profiled_mutex {
+public:
+    explicit profiled_mutex(const char *site = "anonymous") : site_(lock_profiler::instance().site_id(site)) {}
+
+    profiled_mutex(const profiled_mutex &) = delete;
+
+    profiled_mutex &operator=(const profiled_mutex &) = delete;
+
+    void lock() {
+        // 先尝试一次，拿到了就是没有竞争，不需要计时
+        if (m_.try_lock()) {
+            lock_profiler::instance().record_acquire(site_, false, 0);
+            locked_at_ = now();
+            return;
+        }
+        uint64_t begin = now();
+        m_.lock();
+        locked_at_ = now();
+        lock_profiler::instance().record_acquire(site_, true, locked_at_ - begin);
+    }
+
+    bool try_lock() {
+        if (!m_.try_lock()) return false;
+        lock_profiler::instance().record_acquire(site_, false, 0);
+        locked_at_ = now();
+        return true;
+    }
+
+    void unlock() {
+        // locked_at_ 只有持有锁的线程读写，要在释放锁之前读出来
+        uint64_t held = now() - locked_at_;
+        m_.unlock();
+        lock_profiler::instance().record_release(site_, held);
+    }
+
+private:
+    static uint64_t now() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::mutex m_;
+    size_t site_;
+    uint64_t locked_at_ = 0;
+};
+
+// 编译时加上 -DDD_PROFILE_LOCKS，所有默认的 DD 容器都会换成带统计的互斥量
+#ifdef DD_PROFILE_LOCKS
+using default_mutex = profiled_mutex;
+#else
+using default_mutex = std::mutex;
+#endif
+
+// std::condition_variable 只能配合 std::mutex 使用，其他互斥量要用 condition_variable_any
+template<class Mutex>
+using condition_variable_for = std::conditional_t<std::is_same_v<Mutex, std::mutex>,
+                                                  std::condition_variable, std::condition_variable_any>;
+
+// 构造一个互斥量：支持命名的就传入加锁位置的名字(C++17 保证返回值不需要拷贝或移动)
+template<class Mutex>
+Mutex make_mutex(const char *site) {
+    if constexpr (std::is_constructible_v<Mutex, const char *>) {
+        return Mutex(site);
+    } else {
+        return Mutex();
+    }
+}
+}; // namespace DD
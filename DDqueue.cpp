@@ -5,10 +5,15 @@
 #include <cassert>  // assert
 #include <optional> // optional 做为 try_pop 的返回值 -> Cpp17
 
+#include "DDprofiled_mutex.h"
+
 namespace DD {
-template<class T>
+template<class T, class Mutex = default_mutex>
 class Queue { // 无界队列：队列没有容量
 public:
+    // site：互斥量为 profiled_mutex 时统计使用的名字
+    explicit Queue(const char *site = "DD::Queue::m_") : m_(make_mutex<Mutex>(site)) {}
+
     /**
      * std::mutex 和 std::condition_variable 不支持拷贝和赋值操作，
      * 所以我们的队列也应该不支持拷贝和赋值操作。
@@ -24,7 +29,7 @@ public:
     template<class... Args>
     void emplace(Args &&... args) {
         // 加锁
-        std::lock_guard<std::mutex> lk(m_);
+        std::lock_guard<Mutex> lk(m_);
         // 添加元素
         q_.emplace(std::forward<Args>(args)...);
         // 唤醒一个消费者线程
@@ -34,7 +39,7 @@ public:
     // 阻塞
     T pop() {
         // 加锁
-        std::unique_lock<std::mutex> lk(m_);
+        std::unique_lock<Mutex> lk(m_);
         // 判断队列是否不为空，不为空，
         cv_.wait(lk, [this] { return !q_.empty(); });
 
@@ -48,7 +53,7 @@ public:
 
     // 非阻塞
     std::optional<T> try_pop() {
-        std::lock_guard<std::mutex> lk(m_);
+        std::lock_guard<Mutex> lk(m_);
         if (q_.empty()) {
             // 如果
             return {};
@@ -62,8 +67,8 @@ public:
 
 private:
     std::queue<T> q_;
-    std::mutex m_;
-    std::condition_variable cv_;
+    Mutex m_;
+    condition_variable_for<Mutex> cv_;
 };
 }; // namespace DD
 
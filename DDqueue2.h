@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <cassert>
+#include <vector>
+#include <optional> // 作为 try_pop 的返回值
+
+#include "DDprofiled_mutex.h"
+#include "DDsemaphore.h"
+#include "DDtrace.h"
+
+namespace DD {
+template<class T, class Mutex = default_mutex>
+class Queue {    // 有界队列
+public:
+    // site：互斥量为 profiled_mutex 时统计使用的名字；capacity 为 0 表示不限长度
+    Queue(size_t capacity, const char *site = "DD::Queue::m_")
+        : m_(make_mutex<Mutex>(site)), not_full_(int32_t(capacity)), max_queue_size_(capacity), site_(site) {}
+
+    /**
+     * 空位数和元素数分别用一个信号量计数，等待在锁外进行；
+     * 拿到信号量以后队列里一定有空位(元素)，m_ 只保护 deque 本身，不再需要条件变量
+     */
+    template<class M>
+    void push(M &&val) {    // 阻塞
+
+        if (max_queue_size_ > 0) tracer::acquire(not_full_, "wait not_full", site_);
+        std::unique_lock lk(m_);
+        assert(!is_full_locked());
+        q_.push_back(std::forward<M>(val));
+        publish(lk);
+    }
+
+    T pop() {    // 阻塞
+
+        tracer::acquire(not_empty_, "wait not_empty", site_);
+        T ret = take();
+        if (max_queue_size_ > 0) not_full_.release();
+        return ret;
+    }
+
+    template<class M>
+    bool try_push(M &&val) {    // 非阻塞
+
+        if (max_queue_size_ > 0 && !not_full_.try_acquire()) return false;
+        std::unique_lock lk(m_);
+        q_.push_back(std::forward<M>(val));
+        publish(lk);
+        return true;
+    }
+
+    std::optional<T> try_pop() {    // 非阻塞
+
+        if (!not_empty_.try_acquire()) return {};
+        std::optional<T> ret{take()};
+        if (max_queue_size_ > 0) not_full_.release();
+        return ret;
+    }
+
+    bool is_full() {
+        std::lock_guard lk(m_);
+        return is_full_locked();
+    }
+
+    // 供 selector 使用：登记以后每放进一个元素都会 set() 一次这个事件
+    void watch(binary_event *e) {
+        std::lock_guard lk(m_);
+        watchers_.push_back(e);
+    }
+
+    // 返回以后不会再访问 e
+    void unwatch(binary_event *e) {
+        std::lock_guard lk(m_);
+        watchers_.erase(std::remove(watchers_.begin(), watchers_.end(), e), watchers_.end());
+    }
+
+private:
+    /**
+     * 元素已经放进 q_ 后调用，lk 持有 m_。
+     * 没有登记的 selector 时只多一次判空，在锁外 release；
+     * 有的话先 release 再通知(否则被叫醒的 selector 可能 try_pop 不到)，并且都在锁内，保证 unwatch 之后事件不会再被访问
+     */
+    void publish(std::unique_lock<Mutex> &lk) {
+        if (tracer::enabled()) tracer::instance().instant("push", site_, q_.size());
+        if (watchers_.empty()) {
+            lk.unlock();
+            not_empty_.release();
+            return;
+        }
+        not_empty_.release();
+        for (binary_event *e : watchers_) e->set();
+    }
+
+    bool is_full_locked() {
+        return max_queue_size_ > 0 && q_.size() >= max_queue_size_;
+    }
+
+    T take() {
+        std::lock_guard lk(m_);
+        assert(!q_.empty());
+        T ret{std::move_if_noexcept(q_.front())};
+        q_.pop_front();
+        if (tracer::enabled()) tracer::instance().instant("pop", site_, q_.size());
+        return ret;
+    }
+
+    std::deque<T> q_;
+    Mutex m_;
+    counting_semaphore not_full_;     // 空位数
+    counting_semaphore not_empty_;    // 元素数
+    size_t max_queue_size_;
+    std::vector<binary_event *> watchers_;
+    const char *site_;    // 同时用作追踪事件的 label
+};
+}; // namespace DD
@@ -0,0 +1,105 @@
+#include "DDreclaim.h"
+
+// 测试：用两种回收方式实现无锁栈(Treiber stack)，多线程反复 push/pop
+// 检查内存错误：g++ -std=c++17 -g -fsanitize=address DDreclaim.cpp -lpthread
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace DD;
+
+struct node {
+    explicit node(int v) : value(v) {}
+
+    int value;
+    node *next = nullptr;
+};
+
+void push(std::atomic<node *> &head, int v) {
+    node *n = new node(v);
+    n->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed)) {}
+}
+
+// EBR：在 guard 里读 head->next，摘下来的节点交给 retire
+bool pop_epoch(std::atomic<node *> &head, int &out) {
+    epoch_domain::guard g;
+    node *h = head.load(std::memory_order_acquire);
+    while (h && !head.compare_exchange_weak(h, h->next, std::memory_order_acquire)) {}
+    if (!h) return false;
+    out = h->value;
+    epoch_domain::global().retire(h);
+    return true;
+}
+
+// 风险指针：先登记 head，再读 head->next
+bool pop_hazard(std::atomic<node *> &head, int &out) {
+    hazard_domain::hazard_pointer hp;
+    node *h;
+    while (true) {
+        h = hp.protect(head);
+        if (!h) return false;
+        if (head.compare_exchange_strong(h, h->next, std::memory_order_acquire)) break;
+    }
+    hp.reset();
+    out = h->value;
+    hazard_domain::global().retire(h);
+    return true;
+}
+
+// 没有任何回收：直接 delete，和上面对比回收本身的开销(单线程下才安全)
+bool pop_unsafe(std::atomic<node *> &head, int &out) {
+    node *h = head.load(std::memory_order_acquire);
+    if (!h) return false;
+    head.store(h->next, std::memory_order_relaxed);
+    out = h->value;
+    delete h;
+    return true;
+}
+
+template<class Pop>
+void stress(const char *name, Pop pop, int nthreads, int iters) {
+    std::atomic<node *> head{nullptr};
+    std::atomic<long> pushed{0}, popped{0};
+    std::vector<std::thread> threads;
+    auto begin = std::chrono::steady_clock::now();
+    for (int t = 0; t < nthreads; ++t) {
+        threads.emplace_back([&, t] {
+            long s_push = 0, s_pop = 0;
+            for (int i = 0; i < iters; ++i) {
+                push(head, i);
+                s_push += i;
+                int v;
+                if (pop(head, v)) s_pop += v;
+            }
+            pushed += s_push;
+            popped += s_pop;
+        });
+    }
+    for (auto &t : threads) t.join();
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - begin;
+
+    int v;
+    long rest = 0;
+    while (pop(head, v)) rest += v;
+    std::cout << name << ": " << nthreads << " threads, " << d.count() / (double(nthreads) * iters)
+              << " ns per push+pop, sums " << (pushed == popped + rest ? "match" : "MISMATCH") << "\n";
+}
+
+int main() {
+    const int iters = 200000;
+    stress("no reclamation", pop_unsafe, 1, iters);
+    for (int n : {1, 2, 4, 8}) {
+        stress("epoch", pop_epoch, n, iters);
+    }
+    auto &ebr = epoch_domain::global();
+    std::cout << "epoch retired " << ebr.retired_count() << ", reclaimed " << ebr.reclaimed_count()
+              << ", epoch " << ebr.epoch() << "\n";
+
+    for (int n : {1, 2, 4, 8}) {
+        stress("hazard", pop_hazard, n, iters);
+    }
+    auto &hp = hazard_domain::global();
+    std::cout << "hazard retired " << hp.retired_count() << ", reclaimed " << hp.reclaimed_count() << "\n";
+    return 0;
+}
@@ -0,0 +1,424 @@
+#pragma once
+
+// 无锁数据结构的内存回收：基于纪元的回收(EBR) 和 风险指针(hazard pointer)
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace DD {
+namespace detail {
+/**
+ * 非对称栅栏：读者每次进入临界区都要一个 StoreLoad 屏障，mfence 会让连续的缓存未命中无法重叠。
+ * Linux 上用 membarrier 把代价转移给回收的一方：读者只需要编译器屏障，
+ * 回收前让所有线程各执行一次完整的内存屏障。不支持时退化为普通的 seq_cst 栅栏
+ */
+struct asymmetric_fence {
+    static void light() noexcept {
+        if (expedited()) {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        } else {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    static void heavy() noexcept {
+#ifdef __linux__
+        if (expedited()) {
+            syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+            return;
+        }
+#endif
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+private:
+    static bool expedited() noexcept {
+#if defined(__linux__) && !defined(__SANITIZE_THREAD__)
+        static const bool ok = syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+        return ok;
+#else
+        return false;
+#endif
+    }
+};
+
+// 被退休(retire)的节点：摘下来之后可能还有线程在读，要等到安全的时候才能释放
+struct retired_node {
+    void *ptr;
+    void (*deleter)(void *);
+    uint64_t epoch;     // 只有 EBR 使用：退休时的全局纪元
+};
+
+template<class T>
+void delete_node(void *p) { delete static_cast<T *>(p); }
+
+/**
+ * 每个线程在每个 domain 中只注册一次线程记录，线程退出时归还。
+ * 注意：domain 的生命周期必须比所有用过它的线程长，一般直接用 global()
+ */
+template<class Domain>
+typename Domain::thread_record *local_record(Domain *d) {
+    struct cache {
+        std::vector<std::pair<Domain *, typename Domain::thread_record *>> records;
+
+        ~cache() {
+            for (auto &[domain, rec] : records) {
+                domain->release_record(rec);
+            }
+        }
+    };
+    static thread_local cache c;
+
+    for (auto &[domain, rec] : c.records) {
+        if (domain == d) return rec;
+    }
+    auto *rec = d->acquire_record();
+    c.records.emplace_back(d, rec);
+    return rec;
+}
+
+// 线程记录组成一个只增不减的无锁链表，线程退出后记录被标记为空闲，留给新线程复用
+template<class Record>
+Record *acquire_from_list(std::atomic<Record *> &head, std::atomic<size_t> *created = nullptr) {
+    for (Record *r = head.load(std::memory_order_acquire); r; r = r->next) {
+        bool expected = false;
+        if (!r->in_use.load(std::memory_order_relaxed) &&
+            r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return r;
+        }
+    }
+    Record *r = new Record;
+    r->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {}
+    if (created) created->fetch_add(1, std::memory_order_relaxed);
+    return r;
+}
+}; // namespace detail
+
+/*---------------------------- 一、基于纪元的回收 --------------------------------*/
+/**
+ * 读者在访问共享节点之前 pin() 进入当前纪元；节点被摘下后 retire()，记下当时的纪元 e。
+ * 只有所有活跃的线程都已经看到了 e 之后的纪元，全局纪元才能推进；
+ * 全局纪元到达 e + 2 时，不可能还有线程持有这个节点，可以释放。
+ * 退休节点先放在线程自己的列表里，攒够 batch 个才尝试推进纪元并批量释放。
+ */
+class epoch_domain {
+public:
+    struct alignas(64) thread_record {
+        std::atomic<uint64_t> state{0};     // (纪元 << 1) | 是否活跃
+        std::atomic<bool> in_use{true};
+        thread_record *next = nullptr;
+        unsigned depth = 0;                 // pin 的嵌套层数，只有所属线程访问
+        size_t next_collect = 0;            // 退休列表达到这个长度时再尝试回收
+        std::vector<detail::retired_node> retired;
+    };
+
+    // RAII：构造时进入临界区，析构时离开
+    class guard {
+    public:
+        explicit guard(epoch_domain &d = global()) : rec_(detail::local_record(&d)) {
+            if (rec_->depth++ == 0) {
+                uint64_t e = d.epoch_.load(std::memory_order_relaxed);
+                rec_->state.store((e << 1) | 1, std::memory_order_relaxed);
+                // 保证之后对共享节点的读取不会被重排到登记纪元之前
+                detail::asymmetric_fence::light();
+            }
+        }
+
+        guard(const guard &) = delete;
+
+        guard &operator=(const guard &) = delete;
+
+        ~guard() {
+            if (--rec_->depth == 0) {
+                rec_->state.store(rec_->state.load(std::memory_order_relaxed) & ~uint64_t(1),
+                                  std::memory_order_release);
+            }
+        }
+
+    private:
+        thread_record *rec_;
+    };
+
+    explicit epoch_domain(size_t batch = 64) : batch_(batch) {}
+
+    epoch_domain(const epoch_domain &) = delete;
+
+    epoch_domain &operator=(const epoch_domain &) = delete;
+
+    ~epoch_domain() {
+        // 此时不应该再有线程使用这个 domain，所有退休节点都可以直接释放
+        thread_record *r = records_.load(std::memory_order_acquire);
+        while (r) {
+            free_all(r->retired);
+            thread_record *next = r->next;
+            delete r;
+            r = next;
+        }
+        free_all(orphans_);
+    }
+
+    static epoch_domain &global() {
+        static epoch_domain d;
+        return d;
+    }
+
+    // 节点已经从数据结构中摘下，等到没有读者之后调用 deleter 释放
+    void retire(void *p, void (*deleter)(void *)) {
+        thread_record *rec = detail::local_record(this);
+        rec->retired.push_back({p, deleter, epoch_.load(std::memory_order_acquire)});
+        retired_.fetch_add(1, std::memory_order_relaxed);
+        if (rec->retired.size() >= std::max(batch_, rec->next_collect)) {
+            collect(rec);
+        }
+    }
+
+    template<class T>
+    void retire(T *p) { retire(p, &detail::delete_node<T>); }
+
+    // 主动尝试推进纪元并释放当前线程可以释放的节点
+    void collect() { collect(detail::local_record(this)); }
+
+    uint64_t epoch() const noexcept { return epoch_.load(std::memory_order_relaxed); }
+
+    size_t retired_count() const noexcept { return retired_.load(std::memory_order_relaxed); }
+
+    size_t reclaimed_count() const noexcept { return reclaimed_.load(std::memory_order_relaxed); }
+
+private:
+    template<class D>
+    friend typename D::thread_record *detail::local_record(D *);
+
+    thread_record *acquire_record() { return detail::acquire_from_list(records_); }
+
+    // 线程退出：没释放完的节点交给 orphans_，由其他线程以后释放
+    void release_record(thread_record *rec) {
+        if (!rec->retired.empty()) {
+            std::lock_guard<std::mutex> lk(orphans_m_);
+            for (auto &n : rec->retired) {
+                orphans_.push_back(n);
+            }
+            rec->retired.clear();
+        }
+        rec->state.store(0, std::memory_order_relaxed);
+        rec->in_use.store(false, std::memory_order_release);
+    }
+
+    // 所有活跃线程都已经在当前纪元时，把全局纪元加一
+    bool try_advance() {
+        uint64_t e = epoch_.load(std::memory_order_relaxed);
+        detail::asymmetric_fence::heavy();
+        for (thread_record *r = records_.load(std::memory_order_acquire); r; r = r->next) {
+            uint64_t s = r->state.load(std::memory_order_relaxed);
+            if ((s & 1) && (s >> 1) != e) {
+                return false;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return epoch_.compare_exchange_strong(e, e + 1, std::memory_order_release, std::memory_order_relaxed);
+    }
+
+    void collect(thread_record *rec) {
+        try_advance();
+        uint64_t e = epoch_.load(std::memory_order_acquire);
+        free_expired(rec->retired, e);
+
+        // 顺便处理已退出线程留下的节点，拿不到锁就下次再说
+        std::unique_lock<std::mutex> lk(orphans_m_, std::try_to_lock);
+        if (lk.owns_lock()) {
+            free_expired(orphans_, e);
+        }
+        // 有线程停在旧纪元时释放不掉，再攒一批之后重试，避免每次 retire 都扫描整个列表
+        rec->next_collect = rec->retired.size() + batch_;
+    }
+
+    // 退休时的纪元 + 2 <= 当前纪元的节点可以释放
+    void free_expired(std::vector<detail::retired_node> &list, uint64_t e) {
+        auto it = std::partition(list.begin(), list.end(),
+                                 [e](const detail::retired_node &n) { return n.epoch + 2 > e; });
+        for (auto p = it; p != list.end(); ++p) {
+            p->deleter(p->ptr);
+        }
+        reclaimed_.fetch_add(list.end() - it, std::memory_order_relaxed);
+        list.erase(it, list.end());
+    }
+
+    void free_all(std::vector<detail::retired_node> &list) {
+        for (auto &n : list) {
+            n.deleter(n.ptr);
+        }
+        reclaimed_.fetch_add(list.size(), std::memory_order_relaxed);
+        list.clear();
+    }
+
+    alignas(64) std::atomic<uint64_t> epoch_{2};
+    std::atomic<thread_record *> records_{nullptr};
+    std::mutex orphans_m_;
+    std::vector<detail::retired_node> orphans_;
+    std::atomic<size_t> retired_{0};
+    std::atomic<size_t> reclaimed_{0};
+    size_t batch_;
+};
+
+/*---------------------------- 二、风险指针 --------------------------------*/
+/**
+ * 读者在解引用之前把指针登记到一个风险指针槽里，并重新检查它是否还在数据结构中。
+ * 回收时扫描所有槽，被登记的节点暂不释放。
+ * 每个线程未释放的节点数不超过 槽数 * 2 + threshold，垃圾是有界的。
+ */
+class hazard_domain {
+public:
+    struct alignas(64) slot {
+        std::atomic<const void *> ptr{nullptr};
+        std::atomic<bool> in_use{true};
+        slot *next = nullptr;
+    };
+
+    struct thread_record {
+        std::atomic<bool> in_use{true};
+        thread_record *next = nullptr;
+        std::vector<detail::retired_node> retired;
+    };
+
+    // 一个风险指针：持有一个槽，析构时归还
+    class hazard_pointer {
+    public:
+        explicit hazard_pointer(hazard_domain &d = global()) : slot_(d.acquire_slot()) {}
+
+        hazard_pointer(const hazard_pointer &) = delete;
+
+        hazard_pointer &operator=(const hazard_pointer &) = delete;
+
+        ~hazard_pointer() {
+            reset();
+            slot_->in_use.store(false, std::memory_order_release);
+        }
+
+        // 读取 src 并登记，直到登记之后 src 没有变化，返回的指针在 reset 之前都不会被释放
+        template<class T>
+        T *protect(const std::atomic<T *> &src) noexcept {
+            T *p = src.load(std::memory_order_relaxed);
+            while (true) {
+                slot_->ptr.store(p, std::memory_order_relaxed);
+                detail::asymmetric_fence::light();
+                T *q = src.load(std::memory_order_acquire);
+                if (q == p) return p;
+                p = q;
+            }
+        }
+
+        void reset() noexcept { slot_->ptr.store(nullptr, std::memory_order_release); }
+
+    private:
+        slot *slot_;
+    };
+
+    explicit hazard_domain(size_t threshold = 64) : threshold_(threshold) {}
+
+    hazard_domain(const hazard_domain &) = delete;
+
+    hazard_domain &operator=(const hazard_domain &) = delete;
+
+    ~hazard_domain() {
+        for (slot *s = slots_.load(std::memory_order_acquire); s;) {
+            slot *next = s->next;
+            delete s;
+            s = next;
+        }
+        for (thread_record *r = records_.load(std::memory_order_acquire); r;) {
+            for (auto &n : r->retired) n.deleter(n.ptr);
+            thread_record *next = r->next;
+            delete r;
+            r = next;
+        }
+        for (auto &n : orphans_) n.deleter(n.ptr);
+    }
+
+    static hazard_domain &global() {
+        static hazard_domain d;
+        return d;
+    }
+
+    void retire(void *p, void (*deleter)(void *)) {
+        thread_record *rec = detail::local_record(this);
+        rec->retired.push_back({p, deleter, 0});
+        retired_.fetch_add(1, std::memory_order_relaxed);
+        if (rec->retired.size() >= 2 * nslots_.load(std::memory_order_relaxed) + threshold_) {
+            scan(rec->retired);
+        }
+    }
+
+    template<class T>
+    void retire(T *p) { retire(p, &detail::delete_node<T>); }
+
+    size_t retired_count() const noexcept { return retired_.load(std::memory_order_relaxed); }
+
+    size_t reclaimed_count() const noexcept { return reclaimed_.load(std::memory_order_relaxed); }
+
+private:
+    template<class D>
+    friend typename D::thread_record *detail::local_record(D *);
+
+    thread_record *acquire_record() { return detail::acquire_from_list(records_); }
+
+    void release_record(thread_record *rec) {
+        if (!rec->retired.empty()) {
+            std::lock_guard<std::mutex> lk(orphans_m_);
+            for (auto &n : rec->retired) {
+                orphans_.push_back(n);
+            }
+            rec->retired.clear();
+        }
+        rec->in_use.store(false, std::memory_order_release);
+    }
+
+    slot *acquire_slot() { return detail::acquire_from_list(slots_, &nslots_); }
+
+    // 释放所有没有被任何槽登记的节点
+    void scan(std::vector<detail::retired_node> &list) {
+        detail::asymmetric_fence::heavy();
+        std::vector<const void *> hazards;
+        for (slot *s = slots_.load(std::memory_order_acquire); s; s = s->next) {
+            if (const void *p = s->ptr.load(std::memory_order_acquire)) {
+                hazards.push_back(p);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        auto free_unprotected = [&](std::vector<detail::retired_node> &l) {
+            auto it = std::partition(l.begin(), l.end(), [&](const detail::retired_node &n) {
+                return std::binary_search(hazards.begin(), hazards.end(), n.ptr);
+            });
+            for (auto p = it; p != l.end(); ++p) {
+                p->deleter(p->ptr);
+            }
+            reclaimed_.fetch_add(l.end() - it, std::memory_order_relaxed);
+            l.erase(it, l.end());
+        };
+        free_unprotected(list);
+
+        std::unique_lock<std::mutex> lk(orphans_m_, std::try_to_lock);
+        if (lk.owns_lock()) {
+            free_unprotected(orphans_);
+        }
+    }
+
+    std::atomic<slot *> slots_{nullptr};
+    std::atomic<size_t> nslots_{0};
+    std::atomic<thread_record *> records_{nullptr};
+    std::mutex orphans_m_;
+    std::vector<detail::retired_node> orphans_;
+    std::atomic<size_t> retired_{0};
+    std::atomic<size_t> reclaimed_{0};
+    size_t threshold_;
+};
+}; // namespace DD
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+
+namespace DD {
+// 计数策略：在编译期选择引用计数是否需要线程安全
+struct thread_safe {};      // 原子计数，可以在多个线程之间共享
+struct single_thread {};    // 普通计数，只能在一个线程中使用
+
+template<class Policy = thread_safe>
+class ref_count;
+
+// 原子引用计数
+template<>
+class ref_count<thread_safe> {
+public:
+    explicit ref_count(int n = 1) noexcept: count_(n) {}
+
+    int use_count() const noexcept { return count_.load(std::memory_order_relaxed); }
+
+    // 增加引用：新的引用一定是从一个已有的引用拷贝来的，不需要同步任何数据，relaxed 就够了
+    int inc_ref() noexcept { return count_.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+    /**
+     * 减少引用：用 release 保证当前线程对对象的所有修改在计数减少之前完成，
+     * 最后一个减到 0 的线程再用 acquire 栅栏，看到其他线程的全部修改之后才能析构对象。
+     * 只有最后一次才需要 acquire，这样比每次都用 acq_rel 便宜
+     */
+    int dec_ref() noexcept {
+#ifdef __SANITIZE_THREAD__
+        // ThreadSanitizer 不认识单独的栅栏，检测时退化成 acq_rel
+        return count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+#else
+        int n = count_.fetch_sub(1, std::memory_order_release) - 1;
+        if (n == 0) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return n;
+#endif
+    }
+
+private:
+    std::atomic<int> count_;
+};
+
+// 非原子引用计数：对象不会离开创建它的线程时使用
+template<>
+class ref_count<single_thread> {
+public:
+    explicit ref_count(int n = 1) noexcept: count_(n) {}
+
+    int use_count() const noexcept { return count_; }
+
+    int inc_ref() noexcept { return ++count_; }
+
+    int dec_ref() noexcept { return --count_; }
+
+private:
+    int count_;
+};
+}; // namespace DD
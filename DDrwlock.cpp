@@ -0,0 +1,103 @@
+#include "DDrwlock.h"
+
+// 测试：不同读写比例、不同线程数下和 std::shared_mutex 比较
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+using namespace DD;
+
+struct point {
+    long x, y, z;   // 写者保证 x + y == z
+};
+
+// 用锁保护一个 point
+template<class Lock>
+struct locked_point {
+    point load() {
+        std::shared_lock<Lock> lk(m);
+        return p;
+    }
+
+    void store(const point &v) {
+        std::lock_guard<Lock> lk(m);
+        p = v;
+    }
+
+    Lock m;
+    point p{0, 0, 0};
+};
+
+// 每 ratio 次读做一次写，返回总吞吐(百万次/秒)；读到不一致的快照就报错
+template<class Data>
+double bench(Data &d, int nthreads, int ratio, int ops, bool &consistent) {
+    std::vector<std::thread> threads;
+    std::atomic<bool> ok{true};
+    auto begin = std::chrono::steady_clock::now();
+    for (int t = 0; t < nthreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < ops; ++i) {
+                if (i % (ratio + 1) == 0) {
+                    long v = long(t) * ops + i;
+                    d.store(point{v, 1, v + 1});
+                } else {
+                    point p = d.load();
+                    if (p.x + p.y != p.z) ok = false;
+                }
+            }
+        });
+    }
+    for (auto &t : threads) t.join();
+    std::chrono::duration<double> dur = std::chrono::steady_clock::now() - begin;
+    consistent = consistent && ok;
+    return double(nthreads) * ops / dur.count() / 1e6;
+}
+
+int main() {
+    // 1. 配合标准库的 RAII
+    rw_spinlock rw;
+    {
+        std::shared_lock<rw_spinlock> r1(rw);
+        std::shared_lock<rw_spinlock> r2(rw);
+        std::cout << "two readers, try_lock: " << rw.try_lock() << "\n";
+    }
+    {
+        std::lock_guard<rw_spinlock> w(rw);
+        std::cout << "writer, try_lock_shared: " << rw.try_lock_shared() << "\n";
+    }
+
+    seqlock<point> sl;
+    {
+        std::lock_guard<seqlock<point>> w(sl);
+        sl.store_locked(point{1, 2, 3});
+    }
+    std::cout << "seqlock: " << sl.load().z << "\n";
+    {
+        // 两种锁的写者一起加锁
+        std::scoped_lock both(rw, sl);
+        sl.store_locked(point{4, 5, 6});
+        std::cout << "scoped_lock held, seqlock try_lock: " << sl.try_lock() << "\n";
+    }
+    std::cout << "std::try_lock: " << std::try_lock(rw, sl) << "\n";     // -1 表示都拿到了
+    sl.unlock();
+    rw.unlock();
+
+    // 2. 读写比例 1:1 ~ 1000:1
+    const int ops = 200000;
+    bool consistent = true;
+    for (int ratio : {1, 10, 100, 1000}) {
+        for (int n : {1, 2, 4, 8}) {
+            locked_point<std::shared_mutex> a;
+            locked_point<rw_spinlock> b;
+            seqlock<point> c;
+            double x = bench(a, n, ratio, ops, consistent);
+            double y = bench(b, n, ratio, ops, consistent);
+            double z = bench(c, n, ratio, ops, consistent);
+            std::cout << ratio << ":1, " << n << " threads: shared_mutex " << x << " M/s, rw_spinlock " << y
+                      << " M/s, seqlock " << z << " M/s\n";
+        }
+    }
+    std::cout << (consistent ? "all snapshots consistent" : "INCONSISTENT SNAPSHOT") << "\n";
+    return 0;
+}
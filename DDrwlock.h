@@ -0,0 +1,208 @@
+#pragma once
+
+// 读多写少的同步原语：分散读者计数的读写自旋锁 和 顺序锁(seqlock)
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace DD {
+// 自旋等待：先用 pause 指令空转，转久了让出 CPU，避免持锁线程被抢占时白白浪费时间片
+class spin_wait {
+public:
+    void wait() noexcept {
+        if (++count_ < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    unsigned count_ = 0;
+};
+
+/**
+ * 读写自旋锁：读者计数分散在多个缓存行上，每个线程固定使用其中一个，
+ * 读者加锁只修改自己的缓存行，读者之间没有缓存行争用。
+ * 写者先设置 writer_ 标记(新的读者看到后会退让)，再等待所有读者计数归零，所以写者不会饿死。
+ * 满足 Lockable 和 SharedLockable，可以配合 std::lock_guard / std::unique_lock / std::shared_lock 使用
+ */
+class rw_spinlock {
+public:
+    rw_spinlock() = default;
+
+    rw_spinlock(const rw_spinlock &) = delete;
+
+    rw_spinlock &operator=(const rw_spinlock &) = delete;
+
+    void lock_shared() noexcept {
+        auto &c = readers_[slot()].count;
+        spin_wait w;
+        while (true) {
+            // 先登记再检查写者(都是 seq_cst)，写者一侧的顺序正好相反，两边至少有一方能看到对方
+            c.fetch_add(1, std::memory_order_seq_cst);
+            if (!writer_.load(std::memory_order_seq_cst)) return;
+            c.fetch_sub(1, std::memory_order_relaxed);
+            while (writer_.load(std::memory_order_relaxed)) w.wait();
+        }
+    }
+
+    bool try_lock_shared() noexcept {
+        auto &c = readers_[slot()].count;
+        c.fetch_add(1, std::memory_order_seq_cst);
+        if (!writer_.load(std::memory_order_seq_cst)) return true;
+        c.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void unlock_shared() noexcept { readers_[slot()].count.fetch_sub(1, std::memory_order_release); }
+
+    void lock() noexcept {
+        spin_wait w;
+        while (writer_.exchange(true, std::memory_order_seq_cst)) {
+            while (writer_.load(std::memory_order_relaxed)) w.wait();
+        }
+        // 读者计数也要用 seq_cst 读：acquire 读不能阻止它排到上面的 exchange 之前，两边可能都看不到对方
+        for (auto &r : readers_) {
+            while (r.count.load(std::memory_order_seq_cst) != 0) w.wait();
+        }
+    }
+
+    bool try_lock() noexcept {
+        if (writer_.exchange(true, std::memory_order_seq_cst)) return false;
+        for (auto &r : readers_) {
+            if (r.count.load(std::memory_order_seq_cst) != 0) {
+                writer_.store(false, std::memory_order_release);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void unlock() noexcept { writer_.store(false, std::memory_order_release); }
+
+private:
+    static constexpr size_t slots = 64;
+
+    struct alignas(64) reader_slot {
+        std::atomic<int> count{0};
+    };
+
+    // 每个线程第一次使用时分到一个固定的槽，解锁时必须用同一个槽
+    static size_t slot() noexcept {
+        static std::atomic<size_t> next{0};
+        static thread_local size_t s = next.fetch_add(1, std::memory_order_relaxed) % slots;
+        return s;
+    }
+
+    std::array<reader_slot, slots> readers_;
+    alignas(64) std::atomic<bool> writer_{false};
+};
+
+/**
+ * 顺序锁：适合小的、可平凡拷贝的数据快照。
+ * 写者把序号加一(变成奇数)、写数据、再加一(变回偶数)；
+ * 读者读数据前后各读一次序号，两次相同且为偶数说明没有被写者打断，否则重读。
+ * 读者不写任何共享内存，读者再多也不会产生缓存行争用。
+ * 写者之间通过序号互斥，lock()/try_lock()/unlock() 满足 Lockable，可以配合 std::lock_guard、std::scoped_lock
+ * 把多次修改合成一次发布。读者是乐观的、不持有锁，所以没有 lock_shared() 这一套接口，读取一律用 load()
+ */
+template<class T>
+class seqlock {
+    static_assert(std::is_trivially_copyable_v<T>, "seqlock requires a trivially copyable type");
+
+public:
+    seqlock() noexcept: seqlock(T{}) {}
+
+    explicit seqlock(const T &v) noexcept { write_words(v); }
+
+    seqlock(const seqlock &) = delete;
+
+    seqlock &operator=(const seqlock &) = delete;
+
+    T load() const noexcept {
+        spin_wait w;
+        while (true) {
+            unsigned s0 = seq_.load(std::memory_order_acquire);
+            if (s0 & 1) {
+                w.wait();
+                continue;
+            }
+            T out = read_words();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == s0) return out;
+        }
+    }
+
+    void store(const T &v) noexcept {
+        lock();
+        write_words(v);
+        unlock();
+    }
+
+    // 在写锁内基于当前值修改
+    template<class F>
+    void update(F f) {
+        lock();
+        T v = read_words();
+        f(v);
+        write_words(v);
+        unlock();
+    }
+
+    // 写者加锁：序号变成奇数
+    void lock() noexcept {
+        spin_wait w;
+        unsigned s = seq_.load(std::memory_order_relaxed);
+        while ((s & 1) || !seq_.compare_exchange_weak(s, s + 1, std::memory_order_relaxed)) {
+            w.wait();
+            s = seq_.load(std::memory_order_relaxed);
+        }
+        // 数据的写入不能被重排到序号变成奇数之前
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    // 序号是奇数(有写者)或者被别的写者抢先时返回 false
+    bool try_lock() noexcept {
+        unsigned s = seq_.load(std::memory_order_relaxed);
+        if ((s & 1) || !seq_.compare_exchange_strong(s, s + 1, std::memory_order_relaxed)) return false;
+        std::atomic_thread_fence(std::memory_order_release);
+        return true;
+    }
+
+    // 只能在 lock() 之后调用
+    void store_locked(const T &v) noexcept { write_words(v); }
+
+    void unlock() noexcept { seq_.fetch_add(1, std::memory_order_release); }
+
+private:
+    static constexpr size_t words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // 数据按 8 字节的原子变量逐个读写，读者和写者同时访问时不是数据竞争
+    T read_words() const noexcept {
+        uint64_t buf[words];
+        for (size_t i = 0; i < words; ++i) {
+            buf[i] = data_[i].load(std::memory_order_relaxed);
+        }
+        T out;
+        std::memcpy(&out, buf, sizeof(T));
+        return out;
+    }
+
+    void write_words(const T &v) noexcept {
+        uint64_t buf[words] = {};
+        std::memcpy(buf, &v, sizeof(T));
+        for (size_t i = 0; i < words; ++i) {
+            data_[i].store(buf[i], std::memory_order_relaxed);
+        }
+    }
+
+    alignas(64) std::atomic<unsigned> seq_{0};
+    std::atomic<uint64_t> data_[words];
+};
+}; // namespace DD
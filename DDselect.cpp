@@ -0,0 +1,113 @@
+#include "DDselect.h"
+
+// 测试：优先级和轮转；再和轮询 try_pop 的做法比较消费者的 CPU 时间和唤醒延迟
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <sys/resource.h>
+using namespace DD;
+
+using steady = std::chrono::steady_clock;
+
+// 当前线程用掉的 CPU 时间(用户态 + 内核态)，毫秒
+double thread_cpu_ms() {
+    rusage ru{};
+    getrusage(RUSAGE_THREAD, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3 + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e3;
+}
+
+struct result {
+    double cpu_ms;
+    std::vector<int64_t> latency_ns;
+};
+
+/**
+ * 生产者每隔 gap 往三个队列中的一个放一个时间戳，消费者记录从放入到取出的延迟；
+ * use_select 为 false 时消费者轮询三个队列的 try_pop(都为空时 yield)
+ */
+result run(bool use_select, int messages, std::chrono::microseconds gap) {
+    Queue<steady::time_point> control(64), data(64), retry(64);
+    result r;
+    r.latency_ns.reserve(messages);
+
+    std::thread consumer([&] {
+        double cpu = thread_cpu_ms();
+        auto record = [&](steady::time_point t) {
+            r.latency_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(steady::now() - t).count());
+        };
+        if (use_select) {
+            selector sel;
+            sel.add(control, 1, record);
+            sel.add(data, 0, record);
+            sel.add(retry, 0, record);
+            for (int i = 0; i < messages; ++i) sel.select();
+        } else {
+            for (int i = 0; i < messages;) {
+                if (auto v = control.try_pop()) {
+                    record(*v);
+                    ++i;
+                } else if (auto v = data.try_pop()) {
+                    record(*v);
+                    ++i;
+                } else if (auto v = retry.try_pop()) {
+                    record(*v);
+                    ++i;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        r.cpu_ms = thread_cpu_ms() - cpu;
+    });
+
+    // 等 selector 登记好
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    Queue<steady::time_point> *qs[] = {&control, &data, &retry};
+    for (int i = 0; i < messages; ++i) {
+        std::this_thread::sleep_for(gap);
+        qs[i % 3]->push(steady::now());
+    }
+    consumer.join();
+    return r;
+}
+
+void report(const char *name, result r, double wall_ms) {
+    auto &l = r.latency_ns;
+    std::sort(l.begin(), l.end());
+    std::cout << "  " << name << ": consumer CPU " << r.cpu_ms << " ms of " << wall_ms << " ms wall, wake latency p50 "
+              << l[l.size() / 2] / 1000.0 << " us, p99 " << l[l.size() * 99 / 100] / 1000.0 << " us\n";
+}
+
+int main() {
+    // 1. 优先级和公平性：三个队列各放 3 个，control 优先，data 和 retry 轮流
+    {
+        Queue<std::string> control(16), data(16), retry(16);
+        for (int i = 0; i < 3; ++i) {
+            control.push("c" + std::to_string(i));
+            data.push("d" + std::to_string(i));
+            retry.push("r" + std::to_string(i));
+        }
+        selector sel;
+        auto print = [](std::string s) { std::cout << s << " "; };
+        sel.add(control, 1, print);
+        sel.add(data, 0, print);
+        sel.add(retry, 0, print);
+        while (sel.try_select()) {}
+        std::cout << "\n";
+        std::cout << "select_for on empty queues: " << sel.select_for(std::chrono::milliseconds(5)).has_value() << "\n";
+    }
+
+    // 2. CPU 时间和唤醒延迟
+    const int messages = 2000;
+    for (int gap_us : {100, 1000}) {
+        std::cout << messages << " messages, one every " << gap_us << " us:\n";
+        for (bool use_select : {false, true}) {
+            auto begin = steady::now();
+            result r = run(use_select, messages, std::chrono::microseconds(gap_us));
+            double wall = std::chrono::duration<double, std::milli>(steady::now() - begin).count();
+            report(use_select ? "selector    " : "try_pop poll", std::move(r), wall);
+        }
+    }
+    return 0;
+}
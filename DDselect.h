@@ -0,0 +1,121 @@
+#pragma once
+
+// 同时等待多个 DD::Queue：哪个队列先有元素就处理哪个
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "DDqueue2.h"
+#include "DDsemaphore.h"
+
+namespace DD {
+/**
+ * 每个队列登记一个处理函数和优先级(数字越大越优先)。
+ * selector 在所有队列上登记同一个 binary_event，队列放进元素时 set 它；
+ * select() 先按优先级从高到低尝试 try_pop，同一优先级的队列轮流从上次处理的下一个开始，
+ * 都没有元素时睡在事件上，不占 CPU。
+ * 一个 selector 只能由一个线程使用；同一个队列可以同时被 selector 和普通的 pop() 消费。
+ *     DD::selector sel;
+ *     sel.add(control, 1, [](Command c) { ... });
+ *     sel.add(data, 0, [](Packet p) { ... });
+ *     sel.add(retry, 0, [](Packet p) { ... });
+ *     while (running) sel.select();
+ */
+class selector {
+public:
+    selector() = default;
+
+    selector(const selector &) = delete;
+
+    selector &operator=(const selector &) = delete;
+
+    ~selector() {
+        for (auto &e : entries_) e.unwatch();
+    }
+
+    // 返回队列的编号，select() 用它告诉调用方处理的是哪个队列；selector 析构前队列必须一直存在
+    template<class T, class Mutex, class Handler>
+    size_t add(Queue<T, Mutex> &q, int priority, Handler h) {
+        size_t id = entries_.size();
+        q.watch(&ready_);
+        entries_.push_back(entry{
+                id, priority,
+                [&q, h = std::move(h)]() mutable {
+                    std::optional<T> v = q.try_pop();
+                    if (!v) return false;
+                    h(std::move(*v));
+                    return true;
+                },
+                [&q, this] { q.unwatch(&ready_); }});
+        rebuild_groups();
+        return id;
+    }
+
+    // 阻塞到处理了一个元素为止，返回它来自哪个队列
+    size_t select() {
+        while (true) {
+            if (auto id = try_select()) return *id;
+            ready_.wait();
+        }
+    }
+
+    // 最多等待 timeout
+    template<class Rep, class Period>
+    std::optional<size_t> select_for(const std::chrono::duration<Rep, Period> &timeout) {
+        auto deadline = detail::clock::now() + timeout;
+        while (true) {
+            if (auto id = try_select()) return id;
+            auto left = detail::remaining(deadline);
+            if (left.count() == 0 || !ready_.wait_for(left)) return try_select();
+        }
+    }
+
+    // 不阻塞：所有队列都是空的时返回空
+    std::optional<size_t> try_select() {
+        for (auto &g : groups_) {
+            size_t n = g.members.size();
+            for (size_t k = 0; k < n; ++k) {
+                size_t pos = (g.next + k) % n;
+                entry &e = entries_[g.members[pos]];
+                if (e.take()) {
+                    g.next = (pos + 1) % n;
+                    return e.id;
+                }
+            }
+        }
+        return {};
+    }
+
+private:
+    struct entry {
+        size_t id;
+        int priority;
+        std::function<bool()> take;     // try_pop 一个元素并交给处理函数，队列为空时返回 false
+        std::function<void()> unwatch;
+    };
+
+    // 同一优先级的队列，next 是下一轮最先尝试的位置
+    struct group {
+        int priority;
+        std::vector<size_t> members;
+        size_t next = 0;
+    };
+
+    void rebuild_groups() {
+        groups_.clear();
+        for (auto &e : entries_) {
+            auto it = groups_.begin();
+            while (it != groups_.end() && it->priority > e.priority) ++it;
+            if (it == groups_.end() || it->priority != e.priority) it = groups_.insert(it, group{e.priority, {}});
+            it->members.push_back(e.id);
+        }
+    }
+
+    binary_event ready_;
+    std::vector<entry> entries_;
+    std::vector<group> groups_;     // 按优先级从高到低
+};
+}; // namespace DD
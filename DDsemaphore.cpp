@@ -0,0 +1,186 @@
+#include "DDsemaphore.h"
+
+// 测试：和 mutex + condition_variable 比较上下文切换次数和交接延迟
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include <sys/resource.h>
+#include "DDqueue2.h"
+using namespace DD;
+
+using steady = std::chrono::steady_clock;
+
+// 原来用两个条件变量实现的有界队列，作为对照
+template<class T>
+class cv_queue {
+public:
+    explicit cv_queue(size_t capacity) : capacity_(capacity) {}
+
+    void push(T v) {
+        std::unique_lock<std::mutex> lk(m_);
+        not_full_.wait(lk, [this] { return q_.size() < capacity_; });
+        q_.push_back(std::move(v));
+        not_empty_.notify_one();
+    }
+
+    T pop() {
+        std::unique_lock<std::mutex> lk(m_);
+        not_empty_.wait(lk, [this] { return !q_.empty(); });
+        T v = std::move(q_.front());
+        q_.pop_front();
+        not_full_.notify_one();
+        return v;
+    }
+
+private:
+    std::deque<T> q_;
+    std::mutex m_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    size_t capacity_;
+};
+
+// 本进程的(自愿 + 非自愿)上下文切换次数；每次在 futex 上真正睡眠都是一次自愿切换
+long context_switches() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+// 生产者和消费者各 n 个，每个生产者放 items 个
+template<class Q>
+void queue_bench(const char *name, Q &q, int n, int items) {
+    long cs = context_switches();
+    uint64_t calls = detail::futex_calls().load();
+    auto begin = steady::now();
+    std::vector<std::thread> threads;
+    std::atomic<long> sum{0};
+    for (int i = 0; i < n; ++i) {
+        threads.emplace_back([&] {
+            for (int k = 0; k < items; ++k) q.push(k);
+        });
+        threads.emplace_back([&] {
+            long s = 0;
+            for (int k = 0; k < items; ++k) s += q.pop();
+            sum += s;
+        });
+    }
+    for (auto &t : threads) t.join();
+    std::chrono::duration<double, std::milli> d = steady::now() - begin;
+    std::cout << "  " << name << ": " << d.count() << " ms, context switches " << context_switches() - cs;
+    // 条件变量在 glibc 里面，数不到它的 futex 调用
+    if (detail::futex_calls().load() != calls) std::cout << ", futex calls " << detail::futex_calls().load() - calls;
+    std::cout << (sum == long(n) * items * (items - 1) / 2 ? "" : "  WRONG SUM") << "\n";
+}
+
+// 两个线程互相唤醒，返回单程的平均延迟(ns)
+template<class Signal>
+double ping_pong(int rounds) {
+    Signal a, b;
+    std::thread t([&] {
+        for (int i = 0; i < rounds; ++i) {
+            a.wait();
+            b.set();
+        }
+    });
+    auto begin = steady::now();
+    for (int i = 0; i < rounds; ++i) {
+        a.set();
+        b.wait();
+    }
+    std::chrono::duration<double, std::nano> d = steady::now() - begin;
+    t.join();
+    return d.count() / rounds / 2;
+}
+
+// 用 mutex + condition_variable + bool 实现的同样语义的事件
+struct cv_event {
+    void set() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            flag = true;
+        }
+        cv.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [this] { return flag; });
+        flag = false;
+    }
+
+    std::mutex m;
+    std::condition_variable cv;
+    bool flag = false;
+};
+
+int main() {
+    // 1. 基本语义
+    counting_semaphore sem(2);
+    std::cout << "try_acquire: " << sem.try_acquire() << sem.try_acquire() << sem.try_acquire() << "\n";
+    auto begin = steady::now();
+    bool got = sem.try_acquire_for(std::chrono::milliseconds(20));
+    std::cout << "try_acquire_for timed out: " << !got << " after "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(steady::now() - begin).count() << " ms\n";
+
+    latch done(4);
+    std::vector<std::thread> workers;
+    std::atomic<int> finished{0};
+    for (int i = 0; i < 4; ++i) {
+        workers.emplace_back([&] {
+            ++finished;
+            done.count_down();
+        });
+    }
+    done.wait();
+    std::cout << "latch released after " << finished << " workers\n";
+    for (auto &t : workers) t.join();
+
+    binary_event ev;
+    std::cout << "event wait_for before set: " << ev.wait_for(std::chrono::milliseconds(1));
+    ev.set();
+    std::cout << ", after set: " << ev.wait_for(std::chrono::milliseconds(1)) << ", consumed: " << !ev.is_set()
+              << "\n";
+
+    // 2. 没有竞争时的开销：一对 release / acquire
+    const int n = 10000000;
+    begin = steady::now();
+    for (int i = 0; i < n; ++i) {
+        sem.release();
+        sem.acquire();
+    }
+    double sem_ns = std::chrono::duration<double, std::nano>(steady::now() - begin).count() / n;
+    cv_event cve;
+    begin = steady::now();
+    for (int i = 0; i < n; ++i) {
+        cve.set();
+        cve.wait();
+    }
+    double cv_ns = std::chrono::duration<double, std::nano>(steady::now() - begin).count() / n;
+    std::cout << "uncontended signal + wait: semaphore " << sem_ns << " ns, mutex + cv " << cv_ns << " ns\n";
+
+    // 3. 交接延迟
+    const int rounds = 100000;
+    long cs = context_switches();
+    double ev_lat = ping_pong<binary_event>(rounds);
+    long ev_cs = context_switches() - cs;
+    cs = context_switches();
+    double cv_lat = ping_pong<cv_event>(rounds);
+    long cv_cs = context_switches() - cs;
+    std::cout << "ping-pong handoff: binary_event " << ev_lat << " ns (" << ev_cs << " switches), mutex + cv "
+              << cv_lat << " ns (" << cv_cs << " switches)\n";
+
+    // 4. 有界队列
+    for (size_t cap : {size_t(16), size_t(1024)}) {
+        for (int pairs : {1, 4}) {
+            std::cout << "queue capacity " << cap << ", " << pairs << " producer/consumer pairs:\n";
+            cv_queue<int> a(cap);
+            Queue<int, std::mutex> b(cap);
+            queue_bench("mutex + 2 cv  ", a, pairs, 200000);
+            queue_bench("semaphores    ", b, pairs, 200000);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+// 基于 futex 的信号量、事件和 latch：没有竞争时只有一次原子操作，不进内核
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace DD {
+namespace detail {
+// 进程内发起的 futex 系统调用次数，只在慢路径上累加
+inline std::atomic<uint64_t> &futex_calls() {
+    static std::atomic<uint64_t> n{0};
+    return n;
+}
+
+/**
+ * futex 的两个操作：值还等于 expected 时睡眠(检查和睡眠在内核里是原子的，不会丢唤醒)，以及唤醒最多 n 个线程。
+ * timeout 是相对时间，返回 false 表示超时。非 Linux 平台退化为让出 CPU 的忙等。
+ */
+inline bool futex_wait(std::atomic<int32_t> &word, int32_t expected,
+                       std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) {
+#ifdef __linux__
+    static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t), "futex word must be a plain int");
+    timespec ts, *pts = nullptr;
+    if (timeout != std::chrono::nanoseconds::max()) {
+        if (timeout.count() <= 0) return false;
+        ts.tv_sec = time_t(timeout.count() / 1000000000);
+        ts.tv_nsec = long(timeout.count() % 1000000000);
+        pts = &ts;
+    }
+    futex_calls().fetch_add(1, std::memory_order_relaxed);
+    long r = ::syscall(SYS_futex, reinterpret_cast<int32_t *>(&word), FUTEX_WAIT_PRIVATE, expected, pts, nullptr, 0);
+    return !(r == -1 && errno == ETIMEDOUT);
+#else
+    (void) word;
+    (void) expected;
+    (void) timeout;
+    std::this_thread::yield();
+    return true;
+#endif
+}
+
+inline void futex_wake(std::atomic<int32_t> &word, int32_t n) {
+#ifdef __linux__
+    futex_calls().fetch_add(1, std::memory_order_relaxed);
+    ::syscall(SYS_futex, reinterpret_cast<int32_t *>(&word), FUTEX_WAKE_PRIVATE, n, nullptr, nullptr, 0);
+#else
+    (void) word;
+    (void) n;
+#endif
+}
+
+using clock = std::chrono::steady_clock;
+
+// 剩余等待时间，已经到期返回 0
+inline std::chrono::nanoseconds remaining(clock::time_point deadline) {
+    auto d = deadline - clock::now();
+    return d.count() > 0 ? std::chrono::duration_cast<std::chrono::nanoseconds>(d) : std::chrono::nanoseconds(0);
+}
+}; // namespace detail
+
+/**
+ * 计数信号量：count_ 为正表示可用的许可数，为负表示有多少个线程登记了等待。
+ * 许可不够时 acquire() 先登记再睡在 wakeups_ 上；release() 从 count_ 的旧值就知道要叫醒几个线程，
+ * 每个等待者只对应一次 futex_wake，没有等待者时 release() 只是一次原子加法。
+ * (只看"有没有等待者"的做法会在被叫醒、还没来得及运行的线程身上反复 futex_wake)
+ */
+class counting_semaphore {
+public:
+    explicit counting_semaphore(int32_t initial = 0) : count_(initial) {}
+
+    counting_semaphore(const counting_semaphore &) = delete;
+
+    counting_semaphore &operator=(const counting_semaphore &) = delete;
+
+    void acquire() {
+        if (count_.fetch_sub(1, std::memory_order_acquire) > 0) return;
+        while (!take_wakeup()) detail::futex_wait(wakeups_, 0);
+    }
+
+    bool try_acquire() {
+        int32_t c = count_.load(std::memory_order_relaxed);
+        while (c > 0) {
+            if (count_.compare_exchange_weak(c, c - 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    template<class Rep, class Period>
+    bool try_acquire_for(const std::chrono::duration<Rep, Period> &timeout) {
+        if (try_acquire()) return true;
+        auto deadline = detail::clock::now() + timeout;
+        if (count_.fetch_sub(1, std::memory_order_acquire) > 0) return true;
+        while (!take_wakeup()) {
+            auto left = detail::remaining(deadline);
+            if (left.count() == 0) {
+                // 超时：撤销登记；撤销不了说明已经有 release() 把这个线程算进去了，马上会有唤醒
+                int32_t c = count_.load(std::memory_order_relaxed);
+                while (c < 0) {
+                    if (count_.compare_exchange_weak(c, c + 1, std::memory_order_relaxed)) return false;
+                }
+                while (!take_wakeup()) detail::futex_wait(wakeups_, 0);
+                return true;
+            }
+            detail::futex_wait(wakeups_, 0, left);
+        }
+        return true;
+    }
+
+    void release(int32_t n = 1) {
+        int32_t old = count_.fetch_add(n, std::memory_order_release);
+        int32_t wake = old < 0 ? std::min(-old, n) : 0;
+        if (wake > 0) {
+            wakeups_.fetch_add(wake, std::memory_order_release);
+            detail::futex_wake(wakeups_, wake);
+        }
+    }
+
+    int32_t available() const { return std::max(count_.load(std::memory_order_relaxed), int32_t(0)); }
+
+private:
+    bool take_wakeup() {
+        int32_t w = wakeups_.load(std::memory_order_relaxed);
+        while (w > 0) {
+            if (wakeups_.compare_exchange_weak(w, w - 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    std::atomic<int32_t> count_;
+    std::atomic<int32_t> wakeups_{0};   // release() 发给等待者、还没有被领走的唤醒
+};
+
+/**
+ * 自动复位的二元事件：set() 置位，wait() 等到置位并把它清掉(一次 set 只放行一个 wait)。
+ * 状态：0 未置位，1 已置位，2 未置位且可能有线程在睡眠(只有这时 set 才需要 futex_wake)
+ */
+class binary_event {
+public:
+    explicit binary_event(bool set = false) : state_(set ? 1 : 0) {}
+
+    binary_event(const binary_event &) = delete;
+
+    binary_event &operator=(const binary_event &) = delete;
+
+    void set() {
+        if (state_.exchange(1, std::memory_order_release) == 2) detail::futex_wake(state_, INT_MAX);
+    }
+
+    void reset() {
+        int32_t s = 1;
+        state_.compare_exchange_strong(s, 0, std::memory_order_relaxed);
+    }
+
+    bool is_set() const { return state_.load(std::memory_order_relaxed) == 1; }
+
+    bool try_wait() {
+        int32_t s = 1;
+        return state_.compare_exchange_strong(s, 0, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void wait() {
+        while (!try_wait()) {
+            if (prepare_sleep()) detail::futex_wait(state_, 2);
+        }
+    }
+
+    template<class Rep, class Period>
+    bool wait_for(const std::chrono::duration<Rep, Period> &timeout) {
+        auto deadline = detail::clock::now() + timeout;
+        while (!try_wait()) {
+            auto left = detail::remaining(deadline);
+            if (left.count() == 0) return false;
+            if (prepare_sleep()) detail::futex_wait(state_, 2, left);
+        }
+        return true;
+    }
+
+private:
+    // 把 0 改成 2；已经置位就不睡了
+    bool prepare_sleep() {
+        int32_t s = state_.load(std::memory_order_relaxed);
+        while (s != 2) {
+            if (s == 1) return false;
+            if (state_.compare_exchange_weak(s, 2, std::memory_order_relaxed)) break;
+        }
+        return true;
+    }
+
+    std::atomic<int32_t> state_;
+};
+
+/**
+ * 一次性的倒计数门闩，和 std::latch 一样：count_down() 减到 0 时放行所有 wait()。
+ * 减到 0 的那次总是调用 futex_wake，不再读其他成员：等待者可能一醒来就把 latch 销毁了
+ */
+class latch {
+public:
+    explicit latch(int32_t count) : count_(count) {}
+
+    latch(const latch &) = delete;
+
+    latch &operator=(const latch &) = delete;
+
+    void count_down(int32_t n = 1) {
+        if (count_.fetch_sub(n, std::memory_order_release) == n) detail::futex_wake(count_, INT_MAX);
+    }
+
+    bool try_wait() const { return count_.load(std::memory_order_acquire) == 0; }
+
+    void wait() {
+        int32_t c;
+        while ((c = count_.load(std::memory_order_acquire)) != 0) detail::futex_wait(count_, c);
+    }
+
+    void arrive_and_wait(int32_t n = 1) {
+        count_down(n);
+        wait();
+    }
+
+private:
+    std::atomic<int32_t> count_;
+};
+}; // namespace DD
@@ -0,0 +1,37 @@
+#include "DDsharded_counter.h"
+
+// 测试：多线程下的总数是否准确(性能比较见 DDthreadTest.cpp 的 test07)
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace DD;
+
+int main() {
+    sharded_counter requests;
+    gauge in_flight;
+    histogram<> latency;
+
+    const int threads = 8, n = 100000;
+    std::vector<std::thread> ts;
+    for (int t = 0; t < threads; ++t) {
+        ts.emplace_back([&] {
+            for (int i = 0; i < n; ++i) {
+                in_flight.add();
+                ++requests;
+                latency.record(uint64_t(i % 1000));
+                in_flight.sub();
+            }
+        });
+    }
+    // 运行中也可以读，读到的是一个介于开始和结束之间的值
+    std::cout << "requests while running: " << requests.value() << "\n";
+    for (auto &t : ts) t.join();
+
+    auto s = latency.snapshot();
+    std::cout << "requests: " << requests.value() << " (expected " << threads * n << ")\n";
+    std::cout << "in flight: " << in_flight.value() << "\n";
+    std::cout << "latency: count " << s.count << ", mean " << s.mean() << ", p50 <= " << s.percentile(0.5)
+              << ", p99 <= " << s.percentile(0.99) << "\n";
+    std::cout << "take: " << requests.take() << ", after take: " << requests.value() << "\n";
+    return 0;
+}
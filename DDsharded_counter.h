@@ -0,0 +1,161 @@
+#pragma once
+
+// 分片计数器：写操作分散到按缓存行对齐的多个槽里，读时再汇总
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace DD {
+namespace detail {
+constexpr size_t counter_shards = 64;
+
+/**
+ * 每个线程第一次使用时分到一个固定的槽。线程不超过槽数时每个槽只有一个写者，
+ * 原子加法落在自己独占的缓存行上，没有争用；线程更多时几个线程共用一个槽，仍然是正确的
+ */
+inline size_t shard_index() {
+    static std::atomic<size_t> next{0};
+    static thread_local size_t i = next.fetch_add(1, std::memory_order_relaxed) & (counter_shards - 1);
+    return i;
+}
+}; // namespace detail
+
+/**
+ * 只增不减的计数器(请求数、字节数等)。
+ * value() 用 relaxed 读把各个槽加起来：不是某个瞬间的快照，但结果不小于调用开始前完成的所有 add 之和，
+ * 也不大于调用结束时所有 add 之和；每次 add 都恰好被计入一次。
+ */
+class sharded_counter {
+public:
+    sharded_counter() = default;
+
+    sharded_counter(const sharded_counter &) = delete;
+
+    sharded_counter &operator=(const sharded_counter &) = delete;
+
+    void add(uint64_t n = 1) { shards_[detail::shard_index()].v.fetch_add(n, std::memory_order_relaxed); }
+
+    sharded_counter &operator++() {
+        add(1);
+        return *this;
+    }
+
+    uint64_t value() const {
+        uint64_t sum = 0;
+        for (auto &s : shards_) sum += s.v.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    // 取走当前的值并清零；和并发的 add 一起使用时，每次 add 要么算在返回值里，要么留给下一次
+    uint64_t take() {
+        uint64_t sum = 0;
+        for (auto &s : shards_) sum += s.v.exchange(0, std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    struct alignas(64) shard {
+        std::atomic<uint64_t> v{0};
+    };
+
+    std::array<shard, detail::counter_shards> shards_;
+};
+
+/**
+ * 可增可减的量(队列长度、正在处理的请求数等)。
+ * 加和减可能落在不同的槽里，单个槽会是负数；value() 和 sharded_counter 一样是 relaxed 的汇总，
+ * 有并发修改时可能读到一个从未真正出现过的中间值，没有并发修改时是准确的
+ */
+class gauge {
+public:
+    gauge() = default;
+
+    gauge(const gauge &) = delete;
+
+    gauge &operator=(const gauge &) = delete;
+
+    void add(int64_t n = 1) { shards_[detail::shard_index()].v.fetch_add(n, std::memory_order_relaxed); }
+
+    void sub(int64_t n = 1) { add(-n); }
+
+    int64_t value() const {
+        int64_t sum = 0;
+        for (auto &s : shards_) sum += s.v.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    struct alignas(64) shard {
+        std::atomic<int64_t> v{0};
+    };
+
+    std::array<shard, detail::counter_shards> shards_;
+};
+
+/**
+ * 直方图：第 0 个桶是 0，第 i 个桶是 [2^(i-1), 2^i)，超出的都记到最后一个桶。
+ * 每个槽有自己的一组桶，snapshot() 把它们加起来，一致性和 sharded_counter 相同
+ */
+template<size_t Buckets = 32>
+class histogram {
+public:
+    struct summary {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        std::array<uint64_t, Buckets> buckets{};
+
+        // 分位数所在桶的上界
+        uint64_t percentile(double q) const {
+            uint64_t target = uint64_t(q * double(count));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < Buckets; ++i) {
+                seen += buckets[i];
+                if (seen > target) return upper_bound(i);
+            }
+            return upper_bound(Buckets - 1);
+        }
+
+        double mean() const { return count ? double(sum) / double(count) : 0.0; }
+    };
+
+    histogram() = default;
+
+    histogram(const histogram &) = delete;
+
+    histogram &operator=(const histogram &) = delete;
+
+    void record(uint64_t v) {
+        shard &s = shards_[detail::shard_index()];
+        s.buckets[bucket(v)].fetch_add(1, std::memory_order_relaxed);
+        s.count.fetch_add(1, std::memory_order_relaxed);
+        s.sum.fetch_add(v, std::memory_order_relaxed);
+    }
+
+    summary snapshot() const {
+        summary out;
+        for (auto &s : shards_) {
+            out.count += s.count.load(std::memory_order_relaxed);
+            out.sum += s.sum.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < Buckets; ++i) out.buckets[i] += s.buckets[i].load(std::memory_order_relaxed);
+        }
+        return out;
+    }
+
+    static size_t bucket(uint64_t v) {
+        size_t b = v ? size_t(64 - __builtin_clzll(v)) : 0;
+        return b < Buckets ? b : Buckets - 1;
+    }
+
+    static uint64_t upper_bound(size_t i) { return i == 0 ? 0 : (i >= 64 ? UINT64_MAX : (uint64_t(1) << i) - 1); }
+
+private:
+    struct alignas(64) shard {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::array<std::atomic<uint64_t>, Buckets> buckets{};
+    };
+
+    std::array<shard, detail::counter_shards> shards_;
+};
+}; // namespace DD
@@ -1,126 +1,88 @@
-#include <iostream>
-#include <utility>
-
-namespace DD {
-// 引用计数类
-class ref_count {
-public:
-    int use_count() const noexcept { return count_; }
-
-    int inc_ref() noexcept { return ++count_; }
-
-    int dec_ref() noexcept { return --count_; }
-
-private:
-    int count_ = 1;
-};
-
-// shared_ptr类
-template<class T>
-class shared_ptr {
-public:
-    constexpr shared_ptr() noexcept = default;
-
-    constexpr explicit shared_ptr(std::nullptr_t) noexcept: shared_ptr() {}
-
-    explicit shared_ptr(T *ptr) : ptr_(ptr) {
-        if (ptr) {
-            rep_ = new ref_count();
-        }
-    }
-
-    shared_ptr(const shared_ptr &rhs) noexcept: ptr_(rhs.ptr), rep_(rhs.rep_) {
-        if (rep_) {
-            rep_->inc_ref();
-        }
-    }
-
-    shared_ptr(shared_ptr &&rhs) noexcept: ptr_(rhs.ptr_), rep_(rhs.rep_) {
-        rhs.ptr_ = nullptr;
-        rhs.rep_ = nullptr;
-    }
-
-    ~shared_ptr() noexcept {
-        if (rep_ != nullptr && rep_->dec_ref() == 0) {
-            delete ptr_;
-            delete rep_;
-        }
-    }
-
-    shared_ptr &operator=(const shared_ptr &rhs) {
-        shared_ptr(rhs).swap(*this);
-        return *this;
-    }
-
-    shared_ptr &operator=(shared_ptr &&rhs) {
-        shared_ptr(std::move(rhs)).swap(*this);
-        return *this;
-    }
-
-    void swap(shared_ptr &rhs) noexcept {
-        std::swap(ptr_, rhs.ptr_);
-        std::swap(rep_, rhs.rep_);
-    }
-
-    void reset(T *ptr) { shared_ptr(ptr).swap(*this); }
-
-    void reset(std::nullptr_t) noexcept { reset(); };
-
-    T *get() const noexcept { return *ptr_; }
-
-    T &operator*() const noexcept { return *ptr_; }
-
-    T *operator->() const noexcept { return ptr_; }
-
-    int use_count() const noexcept { return rep_ != nullptr ? rep_->use_count() : 0; }
-
-    bool unique() const noexcept { return use_count() == 1; }
-
-    explicit operator bool() const noexcept { return static_cast<bool>(ptr_); }
-
-private:
-    T *ptr_ = nullptr;
-    ref_count *rep_ = nullptr;
-};
-
-template<class T, class... Args>
-auto make_shared(Args &&... args) {
-    return shared_ptr<T>(new T(std::forward<Args>(args)...));
-}
-
-}; // namespace DD
-
-
-// 测试
-#include <vector>
-using namespace DD;
-
-void f(shared_ptr<int> p, int *a) {}
-
-int main() {
-    /**
-     *下面的参数中，执行顺序是不确定的。
-     * 如果执行顺序为 1. new int(1024) 2. int* a = new int(10) 3. shared_ptr<int>()
-     * 那么如果在第 2 步出现了异常，第 3 步就不会执行，那么第 1 步分配的指针就永远都不会被释放
-     * 可以用 make_shared 函数解决
-     */
-    f(shared_ptr<int>(new int(1024)), new int(10));
-    f(make_shared<int>(1024), new int(10));
-
-    make_shared<std::vector<int>>(3, 3);
-}
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+#include "DDshared_ptr.h"
+
+// 测试
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace DD;
+
+// 统计 operator new 的调用次数，用来验证 make_shared 只分配一次
+static std::atomic<long> alloc_count{0};
+
+void *operator new(size_t n) {
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+void f(shared_ptr<int> p, int *a) { delete a; }
+
+// 每个线程对同一个 shared_ptr 反复拷贝、析构，返回每次拷贝+析构的平均耗时(ns)
+template<class Policy>
+double bench_copy(int nthreads, int iters) {
+    auto sp = make_shared<int, Policy>(42);
+    std::vector<std::thread> threads;
+    auto begin = std::chrono::steady_clock::now();
+    for (int t = 0; t < nthreads; ++t) {
+        threads.emplace_back([&sp, iters] {
+            for (int i = 0; i < iters; ++i) {
+                shared_ptr<int, Policy> copy(sp);
+                asm volatile("" : : "r"(copy.get()) : "memory"); // 防止被优化掉
+            }
+        });
+    }
+    for (auto &t : threads) t.join();
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - begin;
+    return d.count() / (double(nthreads) * iters);
+}
+
+int main() {
+    /**
+     *下面的参数中，执行顺序是不确定的。
+     * 如果执行顺序为 1. new int(1024) 2. int* a = new int(10) 3. shared_ptr<int>()
+     * 那么如果在第 2 步出现了异常，第 3 步就不会执行，那么第 1 步分配的指针就永远都不会被释放
+     * 可以用 make_shared 函数解决
+     */
+    f(shared_ptr<int>(new int(1024)), new int(10));
+    f(make_shared<int>(1024), new int(10));
+
+    make_shared<std::vector<int>>(3, 3);
+
+    // 1. 分配次数：shared_ptr(new T) 两次，make_shared 一次
+    long before = alloc_count;
+    { shared_ptr<int> p(new int(1)); }
+    std::cout << "shared_ptr(new T) allocations: " << alloc_count - before << "\n";
+    before = alloc_count;
+    { auto p = make_shared<int>(1); }
+    std::cout << "make_shared allocations: " << alloc_count - before << "\n";
+
+    // 2. 多线程共享：计数必须正确回到 1
+    auto sp = make_shared<int>(0);
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([sp] {
+                for (int i = 0; i < 100000; ++i) {
+                    auto copy = sp;
+                }
+            });
+        }
+        for (auto &t : threads) t.join();
+    }
+    std::cout << "use_count after threads: " << sp.use_count() << "\n";
+
+    // 3. 拷贝+析构的开销：single_thread 只能在一个线程中测
+    const int iters = 2000000;
+    std::cout << "single_thread, 1 thread: " << bench_copy<single_thread>(1, iters) << " ns/op\n";
+    for (int n : {1, 2, 4, 8}) {
+        std::cout << "thread_safe, " << n << " threads: " << bench_copy<thread_safe>(n, iters) << " ns/op\n";
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <memory>   // std::allocator, std::allocator_traits
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "DDref_count.h"
+
+namespace DD {
+// 控制块：保存引用计数，计数为 0 时负责销毁对象并释放自己
+template<class Policy>
+class ctrl_block {
+public:
+    int use_count() const noexcept { return count_.use_count(); }
+
+    void inc_ref() noexcept { count_.inc_ref(); }
+
+    void dec_ref() noexcept {
+        if (count_.dec_ref() == 0) {
+            destroy();
+        }
+    }
+
+protected:
+    ~ctrl_block() = default;
+
+    // 析构对象并释放控制块，不同的分配方式有不同的实现
+    virtual void destroy() noexcept = 0;
+
+private:
+    ref_count<Policy> count_;
+};
+
+// shared_ptr(new T) 使用：对象和控制块是两次分配
+template<class T, class Policy>
+class ctrl_block_ptr final : public ctrl_block<Policy> {
+public:
+    explicit ctrl_block_ptr(T *ptr) noexcept: ptr_(ptr) {}
+
+private:
+    void destroy() noexcept override {
+        delete ptr_;
+        delete this;
+    }
+
+    T *ptr_;
+};
+
+// make_shared / allocate_shared 使用：对象直接构造在控制块内部，只需要一次分配
+template<class T, class Alloc, class Policy>
+class ctrl_block_inplace final : public ctrl_block<Policy> {
+public:
+    using block_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<ctrl_block_inplace>;
+
+    template<class... Args>
+    explicit ctrl_block_inplace(const block_alloc &alloc, Args &&... args) : alloc_(alloc) {
+        ::new(static_cast<void *>(&storage_)) T(std::forward<Args>(args)...);
+    }
+
+    T *get() noexcept { return std::launder(reinterpret_cast<T *>(&storage_)); }
+
+private:
+    void destroy() noexcept override {
+        get()->~T();
+        // 先把分配器拷贝出来，因为它和控制块放在一起，会随控制块一起被释放
+        block_alloc alloc(alloc_);
+        this->~ctrl_block_inplace();
+        std::allocator_traits<block_alloc>::deallocate(alloc, this, 1);
+    }
+
+    block_alloc alloc_;
+    alignas(T) unsigned char storage_[sizeof(T)];
+};
+
+// shared_ptr类：Policy 为 thread_safe 时可以在线程之间传递，single_thread 时计数不用原子操作
+template<class T, class Policy = thread_safe>
+class shared_ptr {
+public:
+    constexpr shared_ptr() noexcept = default;
+
+    constexpr explicit shared_ptr(std::nullptr_t) noexcept: shared_ptr() {}
+
+    explicit shared_ptr(T *ptr) : ptr_(ptr) {
+        if (ptr) {
+            try {
+                rep_ = new ctrl_block_ptr<T, Policy>(ptr);
+            } catch (...) {
+                // 控制块分配失败，不能让 ptr 泄露
+                delete ptr;
+                throw;
+            }
+        }
+    }
+
+    shared_ptr(const shared_ptr &rhs) noexcept: ptr_(rhs.ptr_), rep_(rhs.rep_) {
+        if (rep_) {
+            rep_->inc_ref();
+        }
+    }
+
+    shared_ptr(shared_ptr &&rhs) noexcept: ptr_(rhs.ptr_), rep_(rhs.rep_) {
+        rhs.ptr_ = nullptr;
+        rhs.rep_ = nullptr;
+    }
+
+    ~shared_ptr() noexcept {
+        if (rep_ != nullptr) {
+            rep_->dec_ref();
+        }
+    }
+
+    shared_ptr &operator=(const shared_ptr &rhs) noexcept {
+        shared_ptr(rhs).swap(*this);
+        return *this;
+    }
+
+    shared_ptr &operator=(shared_ptr &&rhs) noexcept {
+        shared_ptr(std::move(rhs)).swap(*this);
+        return *this;
+    }
+
+    void swap(shared_ptr &rhs) noexcept {
+        std::swap(ptr_, rhs.ptr_);
+        std::swap(rep_, rhs.rep_);
+    }
+
+    void reset() noexcept { shared_ptr().swap(*this); }
+
+    void reset(T *ptr) { shared_ptr(ptr).swap(*this); }
+
+    void reset(std::nullptr_t) noexcept { reset(); };
+
+    T *get() const noexcept { return ptr_; }
+
+    T &operator*() const noexcept { return *ptr_; }
+
+    T *operator->() const noexcept { return ptr_; }
+
+    int use_count() const noexcept { return rep_ != nullptr ? rep_->use_count() : 0; }
+
+    bool unique() const noexcept { return use_count() == 1; }
+
+    explicit operator bool() const noexcept { return static_cast<bool>(ptr_); }
+
+private:
+    template<class U, class P, class Alloc, class... Args>
+    friend shared_ptr<U, P> allocate_shared(const Alloc &alloc, Args &&... args);
+
+    // 只给 allocate_shared 使用：控制块已经持有了一个引用
+    shared_ptr(T *ptr, ctrl_block<Policy> *rep) noexcept: ptr_(ptr), rep_(rep) {}
+
+    T *ptr_ = nullptr;
+    ctrl_block<Policy> *rep_ = nullptr;
+};
+
+// 用 alloc 一次性分配控制块和对象
+template<class T, class Policy = thread_safe, class Alloc, class... Args>
+shared_ptr<T, Policy> allocate_shared(const Alloc &alloc, Args &&... args) {
+    using block = ctrl_block_inplace<T, Alloc, Policy>;
+    using block_alloc = typename block::block_alloc;
+    using traits = std::allocator_traits<block_alloc>;
+
+    block_alloc a(alloc);
+    block *p = traits::allocate(a, 1);
+    try {
+        ::new(static_cast<void *>(p)) block(a, std::forward<Args>(args)...);
+    } catch (...) {
+        // T 的构造函数抛出异常，释放刚刚分配的内存
+        traits::deallocate(a, p, 1);
+        throw;
+    }
+    return shared_ptr<T, Policy>(p->get(), p);
+}
+
+template<class T, class Policy = thread_safe, class... Args>
+shared_ptr<T, Policy> make_shared(Args &&... args) {
+    return allocate_shared<T, Policy>(std::allocator<std::remove_cv_t<T>>(), std::forward<Args>(args)...);
+}
+
+}; // namespace DD
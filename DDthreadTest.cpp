@@ -183,6 +183,7 @@ void func06() {
 
 /*---------------------------- 四、条件变量 --------------------------------*/
 // 生产者消费者问题
+#include <condition_variable>
 #include <deque>
 
 std::mutex mutex;
@@ -259,9 +260,53 @@ void func07() {
     }
 }
 
+/*---------------------------- 五、分片计数器 --------------------------------*/
+/**
+ * func06 里所有线程都在修改同一个原子变量，它所在的缓存行在各个核之间来回传递，
+ * 线程越多越慢。分片计数器让每个线程加自己的槽(各占一个缓存行)，读的时候再把所有槽加起来
+ */
+#include <chrono>
+#include <vector>
+#include "DDsharded_counter.h"
+
+// 总共 total 次加一，平均分给 n 个线程，返回每次操作的平均耗时(ns)
+template<class F>
+double bench07(int n, long total, F inc) {
+    std::vector<std::thread> threads;
+    auto begin = std::chrono::steady_clock::now();
+    for (int t = 0; t < n; ++t) {
+        threads.emplace_back([&] {
+            for (long i = 0; i < total / n; ++i) inc();
+        });
+    }
+    for (auto &t : threads) t.join();
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - begin;
+    return d.count() / double(total / n * n);
+}
+
+void test07() {
+    const long total = 1 << 24;
+    for (int n = 1; n <= 64; n *= 2) {
+        long locked = 0;
+        std::atomic<long> single(0);
+        DD::sharded_counter sharded;
+
+        double a = bench07(n, total, [&] {
+            std::lock_guard<std::mutex> lock(mtx);
+            locked++;
+        });
+        double b = bench07(n, total, [&] { single.fetch_add(1, std::memory_order_relaxed); });
+        double c = bench07(n, total, [&] { sharded.add(); });
+
+        std::cout << n << " threads: mutex " << a << " ns, atomic " << b << " ns, sharded " << c << " ns"
+                  << "  (" << locked << " / " << single << " / " << sharded.value() << ")" << std::endl;
+    }
+}
+
 int main() {
 //    test01();
 //    test02();
 //    test05();
-    test06();
+//    test06();
+    test07();
 }
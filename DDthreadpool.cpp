@@ -1,115 +1,112 @@
-#include <cassert>
-#include <condition_variable>
-#include <deque>
-#include <functional>
-#include <mutex>
-#include <thread>
-#include <vector>
-
-namespace DD {
-class thread_pool {
-public:
-    explicit thread_pool(size_t n) : max_queue_size_(n), running_(false) {}
+#include "DDthreadpool.h"
 
-    ~thread_pool() { stop(); }
+// 测试
+#include <algorithm>
+#include <cassert>
+#include <iostream>
 
-    void start(size_t thread_num) {
-        if (running_) return;
+using namespace DD;
 
-        running_ = true;
-        threads_.reserve(thread_num);  // 给容器预先分配空间
-        for (int i = 0; i < thread_num; ++i) {
-            threads_.emplace_back(&thread_pool::worker, this);
-        }
+using steady = std::chrono::steady_clock;
+
+// 忙等 us 微秒，模拟一个计算任务
+void spin_for(int us) {
+    auto end = steady::now() + std::chrono::microseconds(us);
+    while (steady::now() < end) {}
+}
+
+/**
+ * 饱和测试：2 个工作线程、队列长度 16，每个任务 20us；生产者连续提交 n 个任务(比池子的处理能力快得多)，
+ * 记录每次提交在生产者一侧花的时间
+ */
+void saturation(const char *name, overload_policy policy, int mode = 0) {
+    const int n = 20000;
+    basic_thread_pool<std::mutex> pool(16);
+    std::atomic<int> executed{0};
+    if (policy == overload_policy::custom) {
+        // 自定义处理：记下来，稍后再说
+        pool.set_overload_policy(policy, [](basic_thread_pool<std::mutex>::task) {});
+    } else {
+        pool.set_overload_policy(policy);
     }
-
-    // 停止线程池
-    void stop() {
-        if (!running_) return;
-
-        {
-            std::lock_guard<std::mutex> lk(m_);
-
-            running_ = false;
-
-            // 通知所有线程
-            not_full_.notify_all();
-            not_empty_.notify_all();
-        }
-
-        // 回收所有线程
-        for (auto &t : threads_) {
-            if (t.joinable()) t.join();
+    pool.start(2);
+
+    std::vector<int64_t> lat;
+    lat.reserve(n);
+    auto begin = steady::now();
+    for (int i = 0; i < n; ++i) {
+        auto job = [&] {
+            spin_for(20);
+            executed.fetch_add(1, std::memory_order_relaxed);
+        };
+        auto t0 = steady::now();
+        if (mode == 1) {
+            pool.try_submit(job);
+        } else if (mode == 2) {
+            pool.submit_for(job, std::chrono::microseconds(50));
+        } else {
+            pool.submit(job);
         }
+        lat.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(steady::now() - t0).count());
     }
+    std::chrono::duration<double, std::milli> d = steady::now() - begin;
+    pool.stop();
+
+    std::sort(lat.begin(), lat.end());
+    auto s = pool.stats();
+    std::cout << name << ": submit p50 " << lat[n / 2] << " ns, p99 " << lat[n * 99 / 100] << " ns, max "
+              << lat.back() << " ns, producer " << d.count() << " ms, executed " << executed
+              << " | blocked " << s.blocked << ", caller_ran " << s.caller_ran << ", dropped_oldest "
+              << s.dropped_oldest << ", dropped_newest " << s.dropped_newest << ", handled " << s.handled
+              << ", rejected " << s.rejected << std::endl;
+}
 
-    // 生产者线程
-    template <class Fun>
-    void submit(Fun f) {
-        std::unique_lock<std::mutex> lk(m_);
-        not_full_.wait(lk, [this] { return !running_ || !is_full(); });
-
-        if (!running_) throw;
-        assert(!is_full());
-
-        q_.push_back(std::move(f));  // 使用移动
-        not_empty_.notify_one();
+int main() {
+    {
+        thread_pool pool(3);
+        pool.start(3);
+
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([i] {
+                // printf("%d: [%d]\n", std::this_thread::get_id(), i);
+                std::cout << std::this_thread::get_id() << ": [" << i << "]" << std::endl;
+            });
+        }
     }
 
-private:
-    bool is_full() {
-        return max_queue_size_ > 0 && q_.size() >= max_queue_size_;
+    // 停止以后再提交会抛出异常
+    thread_pool stopped(3);
+    try {
+        stopped.submit([] {});
+    } catch (const std::runtime_error &e) {
+        std::cout << "caught: " << e.what() << std::endl;
     }
-
-    // 消费者线程
-    void worker() {
-        while (true) {
-            task t;
-            {
-                std::unique_lock<std::mutex> lk(m_);
-                not_empty_.wait(lk,
-                                [this] { return !running_ || !q_.empty(); });
-
-                if (!running_) return;
-                assert(!q_.empty());
-
-                t = std::move(q_.front());
-                q_.pop_front();
-                not_full_.notify_one();
-            }  // 释放 mutex
-            // 由于 t()
-            // 的执行需要耗费时间，而且它的执行是不需要加锁的，所以执行之前要先释放锁
-            t();
+    std::cout << "try_submit on a stopped pool: " << stopped.try_submit([] {}) << std::endl;
+    std::cout << "submit_for on a stopped pool: " << stopped.submit_for([] {}, std::chrono::milliseconds(1))
+              << ", rejected " << stopped.stats().rejected << std::endl;
+    assert(stopped.stats().rejected == 2);
+
+    // 停止以后可以再次启动，信号量的计数不会因为 stop() 而变多
+    {
+        thread_pool pool(2);
+        std::atomic<int> executed{0};
+        for (int round = 0; round < 3; ++round) {
+            pool.start(2);
+            for (int i = 0; i < 4; ++i) pool.submit([&] { executed.fetch_add(1, std::memory_order_relaxed); });
+            while (executed < 4 * (round + 1)) std::this_thread::yield();
+            pool.stop();
         }
+        std::cout << "restarted pool executed " << executed << " of 12 tasks, size after stop " << pool.size()
+                  << std::endl;
+        assert(executed == 12 && pool.size() == 0);
     }
 
-    using task = std::function<void()>;
-    std::vector<std::thread> threads_;  // 保存创建好的线程
-    std::deque<task> q_;                // 任务队列
-    std::mutex m_;
-    std::condition_variable not_full_;
-    std::condition_variable not_empty_;
-    size_t max_queue_size_;
-    bool running_;  // 标记线程池是否正在运行
-};
-
-};  // namespace DD
-
-// 测试
-#include <iostream>
-
-using namespace DD;
-
-int main() {
-    thread_pool pool(3);
-    pool.start(3);
-
-    for (int i = 0; i < 100; ++i) {
-        pool.submit([i] {
-            // printf("%d: [%d]\n", std::this_thread::get_id(), i);
-            std::cout << std::this_thread::get_id() << ": [" << i << "]" << std::endl;
-        });
-    }
-
+    saturation("block       ", overload_policy::block);
+    saturation("caller_runs ", overload_policy::caller_runs);
+    saturation("drop_oldest ", overload_policy::drop_oldest);
+    saturation("drop_newest ", overload_policy::drop_newest);
+    saturation("custom      ", overload_policy::custom);
+    saturation("try_submit  ", overload_policy::block, 1);
+    saturation("submit_for  ", overload_policy::block, 2);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DDarena.h"
+#include "DDprofiled_mutex.h"
+#include "DDsemaphore.h"
+#include "DDtrace.h"
+
+namespace DD {
+// 有界队列满了以后 submit 的处理方式
+enum class overload_policy {
+    block,          // 等到有空位(默认)
+    caller_runs,    // 在提交任务的线程里直接执行
+    drop_oldest,    // 丢掉队列里最老的任务，把新任务放进去
+    drop_newest,    // 丢掉新提交的任务
+    custom          // 交给 set_overload_policy 设置的处理函数
+};
+
+// 各种处理方式分别发生的次数
+struct overload_stats {
+    uint64_t blocked = 0;
+    uint64_t caller_ran = 0;
+    uint64_t dropped_oldest = 0;
+    uint64_t dropped_newest = 0;
+    uint64_t handled = 0;
+    uint64_t rejected = 0;      // try_submit / submit_for 没有放进去
+};
+
+template<class Mutex = default_mutex>
+class basic_thread_pool {
+public:
+    using task = std::function<void()>;
+    using overload_handler = std::function<void(task)>;
+
+    explicit basic_thread_pool(size_t n, const char *site = "DD::thread_pool::m_")
+        : m_(make_mutex<Mutex>(site)), not_full_(int32_t(n)), max_queue_size_(n), running_(false) {}
+
+    ~basic_thread_pool() { stop(); }
+
+    void start(size_t thread_num) {
+        if (running_) return;
+
+        running_ = true;
+        threads_.reserve(thread_num);  // 给容器预先分配空间
+        // 每个工作线程一个临时内存区，线程退出后还留着，方便 stop() 之后读统计
+        while (arenas_.size() < thread_num) arenas_.push_back(std::make_unique<arena>());
+        for (size_t i = 0; i < thread_num; ++i) {
+            threads_.emplace_back(&basic_thread_pool::worker, this, i);
+        }
+    }
+
+    // 停止线程池；队列里还没执行的任务留着，再次 start() 后继续执行
+    void stop() {
+        if (!running_) return;
+
+        {
+            std::lock_guard<Mutex> lk(m_);
+
+            running_ = false;
+        }
+
+        // 通知所有线程：每个工作线程一个信号；被阻塞的生产者醒来后会把信号传给下一个
+        not_empty_.release(int32_t(threads_.size()));
+        if (max_queue_size_ > 0) not_full_.release();
+
+        // 回收所有线程
+        for (auto &t : threads_) {
+            if (t.joinable()) t.join();
+        }
+        threads_.clear();
+
+        // 收回为了叫醒线程多发的信号，让两个信号量重新等于空位数和任务数，否则再次 start() 后计数不对。
+        // (stop() 时还阻塞在 submit 里的生产者会把空位还回来，所以不要让 submit 和 stop() 并发后再 start())
+        std::lock_guard<Mutex> lk(m_);
+        drain(not_empty_, q_.size());
+        if (max_queue_size_ > 0) drain(not_full_, max_queue_size_ - q_.size());
+    }
+
+    // 在 start() 之前设置；policy 为 custom 时被拒绝的任务交给 handler
+    void set_overload_policy(overload_policy policy, overload_handler handler = {}) {
+        assert(policy != overload_policy::custom || handler);
+        policy_ = policy;
+        handler_ = std::move(handler);
+    }
+
+    // 生产者线程：队列满时按 overload_policy 处理；线程池没有运行时抛出 std::runtime_error
+    template <class Fun>
+    void submit(Fun f) {
+        tracer::scope trace("submit", "DD::thread_pool");
+        if (!running_) throw std::runtime_error("DD::thread_pool: submit on a stopped pool");
+        if (max_queue_size_ > 0 && !not_full_.try_acquire()) {
+            switch (policy_) {
+                case overload_policy::block:
+                    counters_.blocked.fetch_add(1, std::memory_order_relaxed);
+                    tracer::acquire(not_full_, "wait not_full", "DD::thread_pool");
+                    break;
+                case overload_policy::caller_runs:
+                    counters_.caller_ran.fetch_add(1, std::memory_order_relaxed);
+                    f();
+                    return;
+                case overload_policy::drop_oldest:
+                    // 队列可能暂时是空的(空位被还没放进任务的生产者占着)，这时等空位或者等可以替换的任务
+                    while (!not_full_.try_acquire()) {
+                        if (replace_oldest(f)) {
+                            counters_.dropped_oldest.fetch_add(1, std::memory_order_relaxed);
+                            return;
+                        }
+                        std::this_thread::yield();
+                    }
+                    break;
+                case overload_policy::drop_newest:
+                    counters_.dropped_newest.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                case overload_policy::custom:
+                    counters_.handled.fetch_add(1, std::memory_order_relaxed);
+                    handler_(task(std::move(f)));
+                    return;
+            }
+        }
+        if (!enqueue(std::move(f))) throw std::runtime_error("DD::thread_pool: submit on a stopped pool");
+    }
+
+    // 不阻塞：队列满或者线程池没有运行时返回 false，不使用 overload_policy
+    template <class Fun>
+    bool try_submit(Fun f) {
+        // 队列满了，或者占到空位以后发现线程池已经停止，都算没有放进去
+        if ((max_queue_size_ > 0 && !not_full_.try_acquire()) || !enqueue(std::move(f))) {
+            counters_.rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // 最多等待 timeout
+    template <class Fun, class Rep, class Period>
+    bool submit_for(Fun f, const std::chrono::duration<Rep, Period> &timeout) {
+        // 队列满了，或者占到空位以后发现线程池已经停止，都算没有放进去
+        if ((max_queue_size_ > 0 && !not_full_.try_acquire_for(timeout)) || !enqueue(std::move(f))) {
+            counters_.rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    overload_policy policy() const noexcept { return policy_; }
+
+    overload_stats stats() const {
+        overload_stats s;
+        s.blocked = counters_.blocked.load(std::memory_order_relaxed);
+        s.caller_ran = counters_.caller_ran.load(std::memory_order_relaxed);
+        s.dropped_oldest = counters_.dropped_oldest.load(std::memory_order_relaxed);
+        s.dropped_newest = counters_.dropped_newest.load(std::memory_order_relaxed);
+        s.handled = counters_.handled.load(std::memory_order_relaxed);
+        s.rejected = counters_.rejected.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // 线程池中的线程数
+    size_t size() const noexcept { return threads_.size(); }
+
+    // 每个工作线程的 arena 在一个任务里用到的最大字节数
+    std::vector<size_t> arena_high_water() const {
+        std::vector<size_t> r;
+        for (auto &a : arenas_) r.push_back(a->high_water());
+        return r;
+    }
+
+private:
+    // 已经占到一个空位(或者队列不限长度)，把任务放进队列；线程池没有运行时把空位还回去
+    template <class Fun>
+    bool enqueue(Fun &&f) {
+        // 开启追踪时任务开头记一个流的终点，和提交时的起点连起来
+        task t;
+        if (tracer::enabled()) {
+            uint64_t id = tracer::instance().flow_begin("task");
+            t = [id, f = std::forward<Fun>(f)]() mutable {
+                tracer::instance().flow_end("task", id);
+                f();
+            };
+        } else {
+            t = std::forward<Fun>(f);
+        }
+        {
+            std::lock_guard<Mutex> lk(m_);
+            if (!running_) {
+                if (max_queue_size_ > 0) not_full_.release();
+                return false;
+            }
+            assert(!is_full());
+
+            q_.push_back(std::move(t));  // 使用移动
+        }
+        not_empty_.release();
+        return true;
+    }
+
+    // 用新任务替换队头的任务，队列中的任务数不变，两个信号量都不用动
+    template <class Fun>
+    bool replace_oldest(Fun &f) {
+        std::lock_guard<Mutex> lk(m_);
+        if (!running_) throw std::runtime_error("DD::thread_pool: submit on a stopped pool");
+        if (q_.empty()) return false;
+        q_.pop_front();
+        q_.push_back(std::move(f));
+        return true;
+    }
+
+    static void drain(counting_semaphore &s, size_t n) {
+        while (size_t(s.available()) > n && s.try_acquire()) {}
+    }
+
+    bool is_full() {
+        return max_queue_size_ > 0 && q_.size() >= max_queue_size_;
+    }
+
+    // 消费者线程
+    void worker(size_t index) {
+        tracer::instance().set_thread_name("DD::thread_pool worker " + std::to_string(index));
+        arena &scratch = *arenas_[index];
+        this_worker::bind_arena(&scratch);
+        while (true) {
+            task t;
+            tracer::acquire(not_empty_, "wait not_empty", "DD::thread_pool");
+            {
+                std::lock_guard<Mutex> lk(m_);
+                if (!running_) break;
+                assert(!q_.empty());
+
+                t = std::move(q_.front());
+                q_.pop_front();
+            }  // 释放 mutex
+            if (max_queue_size_ > 0) not_full_.release();
+            // 由于 t()
+            // 的执行需要耗费时间，而且它的执行是不需要加锁的，所以执行之前要先释放锁
+            {
+                tracer::scope trace("task", "DD::thread_pool");
+                t();
+                t = nullptr;    // 任务捕获的对象可能用了 arena，先析构再 reset
+            }
+            scratch.reset();
+        }
+        this_worker::bind_arena(nullptr);
+    }
+
+    struct counters {
+        std::atomic<uint64_t> blocked{0};
+        std::atomic<uint64_t> caller_ran{0};
+        std::atomic<uint64_t> dropped_oldest{0};
+        std::atomic<uint64_t> dropped_newest{0};
+        std::atomic<uint64_t> handled{0};
+        std::atomic<uint64_t> rejected{0};
+    };
+
+    std::vector<std::thread> threads_;  // 保存创建好的线程
+    std::vector<std::unique_ptr<arena>> arenas_;    // arenas_[i] 属于第 i 个工作线程
+    std::deque<task> q_;                // 任务队列
+    Mutex m_;
+    counting_semaphore not_full_;   // 队列空位数，max_queue_size_ 为 0 时不用
+    counting_semaphore not_empty_;  // 队列中的任务数
+    size_t max_queue_size_;
+    std::atomic<bool> running_;  // 标记线程池是否正在运行；submit 先不加锁检查一次，放进队列时在 m_ 下再检查
+    overload_policy policy_ = overload_policy::block;
+    overload_handler handler_;
+    counters counters_;
+};
+
+using thread_pool = basic_thread_pool<>;
+
+};  // namespace DD
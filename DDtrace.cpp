@@ -0,0 +1,75 @@
+#include "DDtrace.h"
+
+// 测试：埋点的开销，以及一段线程池 + 队列的 trace(用 ui.perfetto.dev 打开 DDtrace_example.json)
+#include <iostream>
+#include "DDqueue2.h"
+#include "DDthreadpool.h"
+using namespace DD;
+
+using steady = std::chrono::steady_clock;
+
+template<class F>
+double ns_per_event(int n, int events_per_iter, F f) {
+    auto begin = steady::now();
+    for (int i = 0; i < n; ++i) f(i);
+    return std::chrono::duration<double, std::nano>(steady::now() - begin).count() / n / events_per_iter;
+}
+
+void spin_for(int us) {
+    auto end = steady::now() + std::chrono::microseconds(us);
+    while (steady::now() < end) {}
+}
+
+int main() {
+    tracer &tr = tracer::instance();
+
+    // 0. 没有开启追踪时，线程池的工作线程不会登记缓冲
+    for (int i = 0; i < 10; ++i) {
+        thread_pool pool(4);
+        pool.start(4);
+    }
+    std::cout << "threads registered without tracing: " << tr.registered_threads() << "\n";
+
+    // 1. 每个事件的开销
+    const int n = 1000000;
+    volatile int64_t sink = 0;
+    double clock = ns_per_event(n, 1, [&](int) { sink = tr.now(); });
+    double off = ns_per_event(n, 1, [](int) { tracer::scope s("off"); });
+    tr.start(size_t(2) * n + 16);
+    double inst = ns_per_event(n, 1, [&](int i) { tr.instant("instant", nullptr, uint64_t(i)); });
+    tr.start(size_t(2) * n + 16);
+    double scoped = ns_per_event(n, 2, [](int) { tracer::scope s("scope"); });
+    tr.start(16);
+    double full = ns_per_event(n, 1, [&](int i) { tr.instant("dropped", nullptr, uint64_t(i)); });
+    tr.stop();
+    // 每个事件都要读一次 steady_clock，其余的开销是 (instant - clock)
+    std::cout << "steady_clock: " << clock << " ns, disabled scope: " << off << " ns, instant: " << inst << " ns/event, scope: " << scoped
+              << " ns/event, buffer full: " << full << " ns/event (dropped " << tr.dropped() << ")\n";
+
+    // 2. 线程池 + 队列：生产者提交任务，任务把结果放进队列，另一个线程取出
+    tr.start();
+    tr.set_thread_name("main (submitter)");
+    {
+        Queue<int> results(8, "results");
+        std::thread collector([&] {
+            tr.set_thread_name("collector");
+            for (int i = 0; i < 200; ++i) {
+                results.pop();
+                spin_for(30);   // 取得慢，队列会满，任务会在 not_full 上等待
+            }
+        });
+        thread_pool pool(16);
+        pool.start(3);
+        for (int i = 0; i < 200; ++i) {
+            pool.submit([&, i] {
+                spin_for(10 + i % 7 * 10);
+                results.push(i);
+            });
+        }
+        collector.join();
+    }
+    tr.stop();
+    const char *path = "DDtrace_example.json";
+    std::cout << "trace written to " << path << ": " << tr.save(path) << ", dropped " << tr.dropped() << "\n";
+    return 0;
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+// 事件追踪：按线程记录任务、队列和等待事件，导出为 Chrome trace JSON(chrome://tracing 或 ui.perfetto.dev 打开)
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace DD {
+/**
+ * 全局开关 start()/stop()。没有开启时每个埋点只是一次 relaxed 读和一次分支。
+ * 开启后每个线程写自己的定长缓冲(只有所属线程写，写完用 release 发布计数)，写满后新事件丢弃并计数，
+ * 所以内存是有界的：线程数 * capacity * sizeof(event)。
+ * 事件名和 label 必须是静态字符串(只保存指针)。
+ * 导出在 stop() 之后、下一次 start() 之前进行；导出时还在写的线程(比如 stop 前开始的任务结束了)，
+ * 它的新事件可能导出也可能不导出，但不会读到写了一半的事件。
+ */
+class tracer {
+public:
+    // ph 与 Chrome trace 的格式一致：B/E 开始结束，X 带时长，i 瞬时，s/f 流(从提交者连到执行者)
+    struct event {
+        const char *name;
+        const char *label;  // 可以为空，导出到 args.label
+        int64_t ts;         // 相对 start() 的纳秒
+        uint64_t arg;       // X 的时长，s/f 的流编号，i 的数值
+        char ph;
+    };
+
+    static tracer &instance() {
+        static tracer t;
+        return t;
+    }
+
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // 开始新的一次追踪，之前记录的事件全部作废
+    void start(size_t events_per_thread = 1 << 16) {
+        std::lock_guard<std::mutex> lk(m_);
+        capacity_.store(events_per_thread, std::memory_order_relaxed);
+        epoch_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+        // 线程已经退出的缓冲不会再有人写，可以释放
+        for (size_t i = 0; i < buffers_.size();) {
+            if (!buffers_[i]->alive.load(std::memory_order_acquire)) {
+                buffers_[i] = std::move(buffers_.back());
+                buffers_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        gen_.fetch_add(1, std::memory_order_release);
+        enabled_.store(true, std::memory_order_release);
+    }
+
+    void stop() { enabled_.store(false, std::memory_order_release); }
+
+    int64_t now() const {
+        return std::chrono::steady_clock::now().time_since_epoch().count() - epoch_.load(std::memory_order_relaxed);
+    }
+
+    void begin(const char *name, const char *label = nullptr) { record('B', name, label, now(), 0); }
+
+    void end(const char *name, const char *label = nullptr) { record('E', name, label, now(), 0); }
+
+    void instant(const char *name, const char *label = nullptr, uint64_t value = 0) {
+        record('i', name, label, now(), value);
+    }
+
+    // 从 begin_ts 到现在的一段
+    void complete(const char *name, int64_t begin_ts, const char *label = nullptr) {
+        record('X', name, label, begin_ts, uint64_t(now() - begin_ts));
+    }
+
+    // 流的起点，返回的编号交给 flow_end；编号由线程号和线程内序号组成，不需要共享计数器
+    uint64_t flow_begin(const char *name) {
+        buffer *b = local();
+        if (!b) return 0;
+        uint64_t id = (uint64_t(b->tid) << 40) | ++b->next_flow;
+        record('s', name, nullptr, now(), id);
+        return id;
+    }
+
+    // 流的终点，连到当前线程正在进行的那一段上
+    void flow_end(const char *name, uint64_t id) { record('f', name, nullptr, now(), id); }
+
+    // 在导出的 trace 里显示的线程名；先存在线程自己那里，开启追踪后第一次记录事件时才登记
+    void set_thread_name(std::string name) {
+        holder &h = this_thread();
+        h.name = name;
+        if (h.b) {
+            std::lock_guard<std::mutex> lk(m_);
+            h.b->name = std::move(name);
+        }
+    }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // 登记过缓冲的线程数(包括已经退出、下次 start() 时才释放的)
+    size_t registered_threads() {
+        std::lock_guard<std::mutex> lk(m_);
+        return buffers_.size();
+    }
+
+    void write_json(std::ostream &os) {
+        std::lock_guard<std::mutex> lk(m_);
+        uint64_t gen = gen_.load(std::memory_order_acquire);
+        os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        auto sep = [&] {
+            if (!first) os << ",\n";
+            first = false;
+        };
+        for (auto &b : buffers_) {
+            if (!b->name.empty()) {
+                sep();
+                os << R"({"ph":"M","name":"thread_name","pid":1,"tid":)" << b->tid << R"(,"args":{"name":")";
+                write_escaped(os, b->name.c_str());
+                os << "\"}}";
+            }
+            if (b->gen.load(std::memory_order_acquire) != gen) continue;
+            size_t n = b->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; ++i) {
+                sep();
+                write_event(os, b->events[i], b->tid);
+            }
+        }
+        os << "]}\n";
+    }
+
+    bool save(const std::string &path) {
+        std::ofstream out(path);
+        write_json(out);
+        return bool(out);
+    }
+
+    // 开启追踪时在作用域开始和结束各记一个事件；没有开启时什么都不做
+    class scope {
+    public:
+        explicit scope(const char *name, const char *label = nullptr)
+            : name_(name), label_(label), on_(enabled()) {
+            if (on_) instance().begin(name_, label_);
+        }
+
+        scope(const scope &) = delete;
+
+        scope &operator=(const scope &) = delete;
+
+        ~scope() {
+            if (on_) instance().end(name_, label_);
+        }
+
+    private:
+        const char *name_;
+        const char *label_;
+        bool on_;
+    };
+
+    // 阻塞在信号量上：只有真正需要等待并且开启了追踪时才记录一个 X 事件
+    template<class Semaphore>
+    static void acquire(Semaphore &s, const char *name, const char *label = nullptr) {
+        if (!enabled()) {
+            s.acquire();
+            return;
+        }
+        if (s.try_acquire()) return;
+        int64_t t0 = instance().now();
+        s.acquire();
+        instance().complete(name, t0, label);
+    }
+
+private:
+    struct buffer {
+        std::unique_ptr<event[]> events;
+        size_t capacity = 0;
+        std::atomic<size_t> count{0};
+        std::atomic<uint64_t> gen{0};
+        std::atomic<bool> alive{true};
+        unsigned tid = 0;
+        uint64_t next_flow = 0;
+        std::string name;
+    };
+
+    // 线程退出时把缓冲标记为不再使用，下次 start() 时释放
+    struct holder {
+        ~holder() {
+            if (b) b->alive.store(false, std::memory_order_release);
+        }
+
+        std::shared_ptr<buffer> b;
+        std::string name;   // set_thread_name 设置的名字，登记时带过去
+    };
+
+    tracer() = default;
+
+    static holder &this_thread() {
+        static thread_local holder h;
+        return h;
+    }
+
+    // 当前线程的缓冲。还没有缓冲时只在开启追踪时登记，从不追踪的进程里线程再多也不会在 buffers_ 里留下东西；
+    // 没有开启追踪又没有缓冲时返回空
+    buffer *local() {
+        holder &h = this_thread();
+        if (!h.b) {
+            if (!enabled()) return nullptr;
+            h.b = std::make_shared<buffer>();
+            std::lock_guard<std::mutex> lk(m_);
+            h.b->tid = next_tid_++;
+            h.b->name = h.name;
+            buffers_.push_back(h.b);
+        }
+        return h.b.get();
+    }
+
+    void record(char ph, const char *name, const char *label, int64_t ts, uint64_t arg) {
+        buffer *bp = local();
+        if (!bp) return;
+        buffer &b = *bp;
+        uint64_t gen = gen_.load(std::memory_order_acquire);
+        if (b.gen.load(std::memory_order_relaxed) != gen) {
+            // 这个线程在本次追踪中的第一个事件：丢掉上一次的内容
+            size_t cap = capacity_.load(std::memory_order_relaxed);
+            if (b.capacity != cap) {
+                b.events.reset(new event[cap]);
+                b.capacity = cap;
+            }
+            b.count.store(0, std::memory_order_relaxed);
+            b.gen.store(gen, std::memory_order_release);
+        }
+        size_t n = b.count.load(std::memory_order_relaxed);
+        if (n == b.capacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        b.events[n] = event{name, label, ts, arg, ph};
+        b.count.store(n + 1, std::memory_order_release);
+    }
+
+    static void write_escaped(std::ostream &os, const char *s) {
+        for (; *s; ++s) {
+            if (*s == '"' || *s == '\\') os << '\\';
+            os << *s;
+        }
+    }
+
+    static void write_event(std::ostream &os, const event &e, unsigned tid) {
+        os << "{\"ph\":\"" << e.ph << "\",\"name\":\"";
+        write_escaped(os, e.name);
+        int64_t ts = e.ts < 0 ? 0 : e.ts;   // 跨越 start() 的等待
+        os << "\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << ts / 1000 << '.';
+        int64_t frac = ts % 1000;
+        os << char('0' + frac / 100) << char('0' + frac / 10 % 10) << char('0' + frac % 10);
+        switch (e.ph) {
+            case 'X':
+                os << ",\"dur\":" << e.arg / 1000 << '.' << char('0' + e.arg % 1000 / 100)
+                   << char('0' + e.arg % 100 / 10) << char('0' + e.arg % 10);
+                break;
+            case 's':
+                os << ",\"cat\":\"flow\",\"id\":" << e.arg;
+                break;
+            case 'f':
+                os << ",\"cat\":\"flow\",\"bp\":\"e\",\"id\":" << e.arg;
+                break;
+            case 'i':
+                os << ",\"s\":\"t\"";
+                break;
+        }
+        if (e.label || e.ph == 'i') {
+            os << ",\"args\":{";
+            if (e.label) {
+                os << "\"label\":\"";
+                write_escaped(os, e.label);
+                os << '"';
+            }
+            if (e.ph == 'i') os << (e.label ? "," : "") << "\"value\":" << e.arg;
+            os << '}';
+        }
+        os << '}';
+    }
+
+    inline static std::atomic<bool> enabled_{false};
+
+    std::mutex m_;      // 保护 buffers_、线程名和 start()
+    std::vector<std::shared_ptr<buffer>> buffers_;
+    unsigned next_tid_ = 1;
+    std::atomic<size_t> capacity_{0};
+    std::atomic<int64_t> epoch_{0};
+    std::atomic<uint64_t> gen_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+}; // namespace DD
@@ -1,83 +1,70 @@
-#include <utility>
-
-namespace DD {
-template<class T>
-class unique_ptr {
-public:
-    // constexpr：编译期的时候就得到结果，提高运行时的效率
-    constexpr unique_ptr() noexcept = default;
-
-    explicit constexpr unique_ptr(std::nullptr_t) noexcept: unique_ptr() {}
-
-    explicit unique_ptr(T *ptr) noexcept: ptr_(ptr) {}
-
-    // 不允许拷贝构造
-    unique_ptr(const unique_ptr &rhs) = delete;
-
-    // 移动构造
-    unique_ptr(unique_ptr &&rhs) noexcept: ptr_(rhs.release()) {}
-
-    ~unique_ptr() noexcept { delete ptr_; }
-
-    // 不允许拷贝赋值
-    unique_ptr &operator=(const unique_ptr &rhs) = delete;
-
-    // 如果赋一个空指针是可以的
-    constexpr unique_ptr &operator=(std::nullptr_t) {
-        reset();
-        return *this;
-    }
-
-    // 移动赋值
-    unique_ptr &operator=(unique_ptr &&rhs) noexcept {
-        // 获得 rhs 的指针，并为当前 unique_ptr 设置该指针
-        reset(rhs.release());
-        return *this;
-    }
-
-    // 得到裸指针
-    T *get() const noexcept { return ptr_; }
-
-    // 释放管理的指针，并返回这个指针
-    T *release() noexcept { return std::exchange(ptr_, nullptr); }
-
-    // 更换管理的指针，并将原来的指针释放
-    void reset(T *ptr) noexcept { delete std::exchange(ptr_, ptr); }
-
-    // 交换
-    void swap(unique_ptr &rhs) noexcept { std::swap(ptr_, rhs.ptr_); }
-
-    // 注意：如果对空指针解引用会抛出异常
-    T &operator*() const { return *ptr_; }
-
-    T *operator->() const noexcept { return ptr_; }
-
-    // 将指针转为bool类型
-    explicit operator bool() const noexcept { return static_cast<bool>(ptr_); }
-
-private:
-    T *ptr_ = nullptr;
-};
-
-template<class T, class... Args>
-auto make_unique(Args &&... args) {
-    return unique_ptr<T>(new T(std::forward<Args>(args)...));
-}
-
-}; // namespace DD
-
-// 测试
-#include <vector>
-using namespace DD;
-
-int main() {
-
-    const unique_ptr<int> p1;
-    unique_ptr<const int> p2;
-
-    auto p = make_unique<int>(10);
-
-    make_unique<std::vector<int>>(3, 3);
-
-    return 0;
-}
+#include "DDunique_ptr.h"
+
+// 测试
+#include <cstdio>
+#include <iostream>
+#include <vector>
+using namespace DD;
+
+// 无状态的删除器不占空间
+struct file_closer {
+    void operator()(FILE *f) const noexcept { std::fclose(f); }
+};
+
+// 有状态的删除器(这里记录关闭了几个文件)和函数指针一样要占空间
+struct counting_closer {
+    int *closed;
+
+    void operator()(FILE *f) const noexcept {
+        std::fclose(f);
+        ++*closed;
+    }
+};
+
+// final 的删除器不能做基类，作为成员存放
+struct final_closer final {
+    void operator()(FILE *f) const noexcept { std::fclose(f); }
+};
+
+struct base {
+    virtual ~base() = default;
+};
+
+struct derived : base {
+    ~derived() override { std::cout << "~derived\n"; }
+};
+
+int main() {
+
+    const unique_ptr<int> p1;
+    unique_ptr<const int> p2;
+
+    auto p = make_unique<int>(10);
+
+    make_unique<std::vector<int>>(3, 3);
+
+    unique_ptr<FILE, file_closer> f(std::tmpfile());
+    int closed = 0;
+    {
+        unique_ptr<FILE, counting_closer> g(std::tmpfile(), counting_closer{&closed});
+        unique_ptr<FILE, int (*)(FILE *)> h(std::tmpfile(), &std::fclose);
+        unique_ptr<FILE, final_closer> k(std::tmpfile());
+        counting_closer shared{&closed};
+        unique_ptr<FILE, counting_closer &> r(std::tmpfile(), shared);
+        std::cout << "sizeof(unique_ptr<int>) = " << sizeof(unique_ptr<int>)
+                  << ", sizeof(unique_ptr<FILE, file_closer>) = " << sizeof(f)
+                  << ", sizeof(unique_ptr<FILE, counting_closer>) = " << sizeof(g)
+                  << ", sizeof(unique_ptr<FILE, int (*)(FILE *)>) = " << sizeof(h)
+                  << ", sizeof(unique_ptr<FILE, final_closer>) = " << sizeof(k) << "\n";
+        static_assert(sizeof(unique_ptr<FILE, file_closer>) == sizeof(FILE *));
+        static_assert(sizeof(unique_ptr<FILE, counting_closer>) == 2 * sizeof(FILE *));
+        static_assert(sizeof(unique_ptr<FILE, int (*)(FILE *)>) == 2 * sizeof(FILE *));
+    }
+    std::cout << "counting_closer closed " << closed << " files\n";  // g 和 r 各一个
+
+    // unique_ptr<derived> 转换成 unique_ptr<base>
+    unique_ptr<base> b = make_unique<derived>();
+    b = make_unique<derived>();
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace DD {
+// 默认的删除器：没有任何成员，配合空基类优化不占空间
+template<class T>
+struct default_delete {
+    constexpr default_delete() noexcept = default;
+
+    // 允许 unique_ptr<Derived> 转换成 unique_ptr<Base>
+    template<class U>
+    default_delete(const default_delete<U> &) noexcept {}
+
+    void operator()(T *ptr) const noexcept { delete ptr; }
+};
+
+namespace detail {
+// 空基类优化：无状态、又不是 final 的删除器就继承它，不占任何空间
+template<class T, class D, bool = std::is_empty_v<D> && !std::is_final_v<D>>
+struct unique_ptr_storage : D {
+    constexpr unique_ptr_storage() noexcept = default;
+
+    explicit unique_ptr_storage(T *p) noexcept: ptr(p) {}
+
+    unique_ptr_storage(T *p, D d) noexcept: D(std::forward<D>(d)), ptr(p) {}
+
+    D &deleter() noexcept { return *this; }
+
+    const D &deleter() const noexcept { return *this; }
+
+    T *ptr = nullptr;
+};
+
+// 函数指针、引用、有状态的或者 final 的删除器不能做基类，作为成员存放
+template<class T, class D>
+struct unique_ptr_storage<T, D, false> {
+    constexpr unique_ptr_storage() noexcept: d() {}
+
+    explicit unique_ptr_storage(T *p) noexcept: d(), ptr(p) {}
+
+    unique_ptr_storage(T *p, D d) noexcept: d(std::forward<D>(d)), ptr(p) {}
+
+    D &deleter() noexcept { return d; }
+
+    const D &deleter() const noexcept { return d; }
+
+    D d;
+    T *ptr = nullptr;
+};
+}; // namespace detail
+
+template<class T, class Deleter = default_delete<T>>
+class unique_ptr {
+public:
+    // constexpr：编译期的时候就得到结果，提高运行时的效率
+    constexpr unique_ptr() noexcept = default;
+
+    explicit constexpr unique_ptr(std::nullptr_t) noexcept: unique_ptr() {}
+
+    explicit unique_ptr(T *ptr) noexcept: s_(ptr) {}
+
+    unique_ptr(T *ptr, Deleter d) noexcept: s_(ptr, std::forward<Deleter>(d)) {}
+
+    // 不允许拷贝构造
+    unique_ptr(const unique_ptr &rhs) = delete;
+
+    // 移动构造：删除器也要一起移动过来(删除器是引用时还是引用同一个对象)
+    unique_ptr(unique_ptr &&rhs) noexcept: s_(rhs.release(), std::forward<Deleter>(rhs.get_deleter())) {}
+
+    // unique_ptr<Derived> 转换成 unique_ptr<Base>：指针能隐式转换，删除器能转换(删除器是引用时必须相同)
+    template<class U, class E, class = std::enable_if_t<
+            std::is_convertible_v<U *, T *> &&
+            (std::is_reference_v<Deleter> ? std::is_same_v<E, Deleter> : std::is_convertible_v<E, Deleter>)>>
+    unique_ptr(unique_ptr<U, E> &&rhs) noexcept: s_(rhs.release(), std::forward<E>(rhs.get_deleter())) {}
+
+    ~unique_ptr() noexcept {
+        if (s_.ptr) get_deleter()(s_.ptr);
+    }
+
+    // 不允许拷贝赋值
+    unique_ptr &operator=(const unique_ptr &rhs) = delete;
+
+    // 如果赋一个空指针是可以的
+    constexpr unique_ptr &operator=(std::nullptr_t) {
+        reset();
+        return *this;
+    }
+
+    // 移动赋值
+    unique_ptr &operator=(unique_ptr &&rhs) noexcept {
+        // 获得 rhs 的指针，并为当前 unique_ptr 设置该指针
+        reset(rhs.release());
+        get_deleter() = std::forward<Deleter>(rhs.get_deleter());
+        return *this;
+    }
+
+    template<class U, class E, class = std::enable_if_t<
+            std::is_convertible_v<U *, T *> && std::is_assignable_v<Deleter &, E &&>>>
+    unique_ptr &operator=(unique_ptr<U, E> &&rhs) noexcept {
+        reset(rhs.release());
+        get_deleter() = std::forward<E>(rhs.get_deleter());
+        return *this;
+    }
+
+    // 得到裸指针
+    T *get() const noexcept { return s_.ptr; }
+
+    Deleter &get_deleter() noexcept { return s_.deleter(); }
+
+    const Deleter &get_deleter() const noexcept { return s_.deleter(); }
+
+    // 释放管理的指针，并返回这个指针
+    T *release() noexcept { return std::exchange(s_.ptr, nullptr); }
+
+    // 更换管理的指针，并将原来的指针释放
+    void reset(T *ptr = nullptr) noexcept {
+        if (T *old = std::exchange(s_.ptr, ptr)) get_deleter()(old);
+    }
+
+    // 交换
+    void swap(unique_ptr &rhs) noexcept {
+        std::swap(s_.ptr, rhs.s_.ptr);
+        std::swap(get_deleter(), rhs.get_deleter());
+    }
+
+    // 注意：如果对空指针解引用会抛出异常
+    T &operator*() const { return *s_.ptr; }
+
+    T *operator->() const noexcept { return s_.ptr; }
+
+    // 将指针转为bool类型
+    explicit operator bool() const noexcept { return static_cast<bool>(s_.ptr); }
+
+private:
+    detail::unique_ptr_storage<T, Deleter> s_;
+};
+
+template<class T, class... Args>
+auto make_unique(Args &&... args) {
+    return unique_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+}; // namespace DD
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <iostream> // size_t
+#include <memory> // std::allocator, std::allocator_traits
+#include <utility> // std::exchage>
+
+namespace DD {
+// Alloc 决定内存从哪里来，默认是 operator new；换成 DD::arena_allocator 就从线程池工作线程的临时内存区分配
+template<class T, class Alloc = std::allocator<T>>
+class vector {
+    using traits = std::allocator_traits<Alloc>;
+
+public:
+    using allocator_type = Alloc;
+
+    // 跟分配内存无关的函数应该为 noexcept
+    vector() noexcept(noexcept(Alloc())) = default;
+
+    explicit vector(const Alloc &a) noexcept : alloc_(a) {}
+
+    // explicit不允许隐式类型转换
+    explicit vector(size_t n, const Alloc &a = Alloc()) : alloc_(a), cap_(n), ptr_(alloc(cap_)) {
+        for (; size_ < n; ++size_) {
+            construct(ptr_ + size_);
+        }
+    }
+
+    vector(size_t n, const T &x, const Alloc &a = Alloc()) : alloc_(a), cap_(n), ptr_(alloc(cap_)) {
+        for (; size_ < n; ++size_) {
+            construct(ptr_ + size_, x);
+        }
+    }
+
+    // 拷贝构造
+    vector(const vector &rhs)
+        : alloc_(std::allocator_traits<Alloc>::select_on_container_copy_construction(rhs.alloc_)),
+          cap_(rhs.size()), ptr_(alloc(cap_)) {
+        for (; size_ < rhs.size(); ++size_) {
+            construct(ptr_ + size_, rhs[size_]);
+        }
+    }
+
+    // 拷贝到指定 allocator 的内存上
+    vector(const vector &rhs, const Alloc &a) : alloc_(a), cap_(rhs.size()), ptr_(alloc(cap_)) {
+        for (; size_ < rhs.size(); ++size_) {
+            construct(ptr_ + size_, rhs[size_]);
+        }
+    }
+
+    // 移动构造
+    vector(vector &&rhs) noexcept : alloc_(std::move(rhs.alloc_)) {
+//        cap_ = rhs.cap_;
+//        rhs.cap_ = 0;
+        cap_ = std::exchange(rhs.cap_, 0);
+        size_ = std::exchange(rhs.size_, 0);
+        ptr_ = std::exchange(rhs.ptr_, nullptr);
+    }
+
+    // 初始化列表
+    vector(std::initializer_list<T> il, const Alloc &a = Alloc()) : alloc_(a), cap_(il.size()), ptr_(alloc(cap_)) {
+        for (auto &x : il) {
+            construct(ptr_ + size_, x);
+            ++size_;
+        }
+    }
+
+    ~vector() noexcept {
+        clear();
+        dealloc(ptr_);
+    }
+
+    // allocator 只有在 propagate_on_container_swap 时才交换；不交换时两边的 allocator 必须相等(和 std::vector 一样)
+    void swap(vector &rhs) noexcept {
+//        T* tmp = rhs.ptr_;
+//        rhs.ptr_ = ptr_;
+//        ptr_ = tmp;
+        using std::swap;
+        if constexpr (traits::propagate_on_container_swap::value) swap(alloc_, rhs.alloc_);
+        swap(cap_, rhs.cap_);
+        swap(size_, rhs.size_);
+        swap(ptr_, rhs.ptr_);
+    }
+
+    void clear() noexcept {
+        for (; size_ > 0; --size_) {
+            destroy(ptr_ + size_ - 1);
+        }
+    }
+
+    // 拷贝赋值
+    vector &operator=(const vector &rhs) {
+        if (this != &rhs) {
+            // 先拷贝构造一个临时的 vector, 将它与当前的vector交换。这个临时的vector会在出作用域的时候进行析构
+            // 好处：如果在构造的时候发生异常，原来的 vector 不会受到影响
+            // 临时 vector 用的是赋值后 *this 应该用的 allocator：只有 propagate_on_container_copy_assignment 时才换成 rhs 的
+            constexpr bool propagate = traits::propagate_on_container_copy_assignment::value;
+            vector(rhs, propagate ? rhs.alloc_ : alloc_).swap_all(*this);
+        }
+        return *this;
+    }
+
+    // 移动赋值
+    vector &operator=(vector &&rhs) noexcept(traits::propagate_on_container_move_assignment::value ||
+                                             traits::is_always_equal::value) {
+        if (this != &rhs) {
+            if (traits::propagate_on_container_move_assignment::value || alloc_ == rhs.alloc_) {
+                // 同理：先移动构造一个临时的vector，再将它与当前的vector交换
+                // 虽然rhs参数传进来的是右值，但是这个形参rhs是有名字的，所以还是个左值，所以还要用std::move转换为右值
+                vector(std::move(rhs)).swap_all(*this);
+            } else {
+                // allocator 不传播又不相等(比如两个线程的 arena)：不能接管 rhs 的内存，只能逐个移动元素
+                vector tmp(alloc_);
+                tmp.reserve(rhs.size());
+                for (auto &x : rhs) tmp.emplace_back(std::move(x));
+                tmp.swap_all(*this);
+            }
+        }
+        return *this;
+    }
+
+    // 初始化列表赋值
+    vector &operator=(std::initializer_list<T> il) {
+        // 同理
+        vector(il, alloc_).swap_all(*this);
+        return *this;
+    }
+
+    void push_back(const T &x) {
+        emplace_back(x);
+    }
+
+    // 右值
+    void push_back(T &&x) {
+        emplace_back(std::move(x));
+    }
+
+    template<class... Args>
+    // 可变参模版
+    void emplace_back(Args &&... args) {
+        if (size_ == cap_) {
+            // 扩容：2倍
+            reallocate(cap_ != 0 ? cap_ * 2 : 1);
+        }
+        // 添加新元素
+        construct(ptr_ + size_, std::forward<Args>(args)...);
+        ++size_;
+    }
+
+    void pop_back() noexcept {
+        destroy(ptr_ + size_ - 1);
+        --size_;
+    }
+
+    // 预先分配至少能放 n 个元素的空间，之后 n 个以内的 emplace_back 不会再搬移元素
+    void reserve(size_t n) {
+        if (n > cap_) reallocate(n);
+    }
+
+    // 加上 const 类型，不然 const vector 对象不能访问这个成员方法
+    size_t size() const noexcept { return size_; }
+
+    size_t capacity() const noexcept { return cap_; }
+
+    bool empty() const noexcept { return size_ == 0; }
+
+    Alloc get_allocator() const noexcept { return alloc_; }
+
+    T &operator[](size_t i) { return ptr_[i]; }
+
+    const T &operator[](size_t i) const { return ptr_[i]; }
+
+    T &back() { return ptr_[size_ - 1]; }
+
+    const T &back() const { return ptr_[size_ - 1]; }
+
+    T *begin() noexcept { return ptr_; }
+
+    T *end() noexcept { return ptr_ + size_; }
+
+    const T *begin() const noexcept { return ptr_; }
+
+    const T *end() const noexcept { return ptr_ + size_; }
+
+private:
+    // 连同 allocator 一起交换，赋值时把临时 vector 的内容和 allocator 一起换过来
+    void swap_all(vector &rhs) noexcept {
+        using std::swap;
+        swap(alloc_, rhs.alloc_);
+        swap(cap_, rhs.cap_);
+        swap(size_, rhs.size_);
+        swap(ptr_, rhs.ptr_);
+    }
+
+    // 分配内存；std::allocator 对超过默认对齐的类型(比如按缓存行对齐的结构)会用带对齐参数的 operator new
+    T *alloc(size_t n) {
+        return n ? traits::allocate(alloc_, n) : nullptr;
+    }
+
+    // 释放内存
+    void dealloc(T *p) noexcept {
+        if (p) traits::deallocate(alloc_, p, cap_);
+    }
+
+    // 换到一块能放 new_cap 个元素的新内存上
+    void reallocate(size_t new_cap) {
+        auto new_ptr = alloc(new_cap);
+        // 拷贝/移动旧元素
+        for (size_t new_size = 0; new_size < size_; ++new_size) {
+            // move_if_noexcept 只有在异常的时候才会移动，否则执行拷贝操作
+            construct(new_ptr + new_size, std::move_if_noexcept(ptr_[new_size]));
+        }
+        // 析构旧元素并释放旧内存
+        for (size_t i = 0; i < size_; ++i) {
+            destroy(ptr_ + i);
+        }
+        dealloc(ptr_);     // 用的是旧的 cap_
+        cap_ = new_cap;
+        ptr_ = new_ptr;
+    }
+
+    // 元素构造
+    template<class... Args>
+    void construct(T *p, Args &&... args) {
+        // 调用构造函数, 调用 placement new
+        ::new(p) T(std::forward<Args>(args)...); // 调用 T 的构造函数，使用完美转发
+    }
+
+    // 元素析构
+    void destroy(T *p) noexcept {
+        p->~T();
+    }
+
+    Alloc alloc_;
+    size_t cap_ = 0;
+    size_t size_ = 0;
+    T *ptr_ = nullptr; // 存放在堆中
+};
+
+template<class T, class Alloc>
+void swap(vector<T, Alloc> &a, vector<T, Alloc> &b) {
+    a.swap(b);
+}
+}; // namespace DD